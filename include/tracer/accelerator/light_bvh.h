@@ -0,0 +1,92 @@
+#pragma once
+#include "tracer/core/aabb.h"
+#include "tracer/core/hittable.h"
+#include "tracer/core/hittable_list.h"
+#include "tracer/math/alias_table.h"
+#include "tracer/math/drand48.h"
+#include "tracer/math/math.h"
+
+namespace tracer {
+
+// 一组光源的空间范围、发光方向锥和总功率
+struct LightBounds {
+  AABB bounds;
+  Vec3 axis{0.0f, 0.0f, 1.0f};
+  float cos_theta_o = -1.0f; // -1 表示向所有方向发光
+  float power = 0.0f;
+
+  // 从 p 点看这组光源的重要性（功率 / 距离²，再按方向锥衰减）
+  float importance(const Point3 &p) const;
+
+  static LightBounds merge(const LightBounds &a, const LightBounds &b);
+};
+
+enum class LightSampling {
+  Power, // 按功率的别名表选光源，O(1)，与着色点位置无关
+  Tree   // 自顶向下按子树重要性选光源，O(log n)，对远处/背对的光源降权
+};
+
+// 光源采样结构，替代 hittable_list 的均匀选择。
+// pdf_value 沿光线遍历光源 BVH，只访问方向上可能命中的光源，O(log n)。
+// 没有包围盒的光源（如平行光）不进树，与整棵树一起均匀选择
+class LightBVH : public hittable {
+public:
+  LightBVH(const hittable_list &lights,
+           LightSampling mode = LightSampling::Tree);
+
+  virtual bool hit(const Ray &r, float t_min, float t_max,
+                   hit_record &rec) const override;
+
+  virtual bool bounding_box(float t0, float t1,
+                            AABB &output_box) const override;
+
+  virtual float pdf_value(const Point3 &o, const Vec3 &v) const override;
+
+  virtual Vec3 random(const Vec3 &o) const override;
+
+  // 与 random 相同的分层，树内的光源按功率别名表选择
+  virtual bool emit_photon(const AABB &scene, Ray &ray,
+                           Color &flux) const override;
+
+  // 只访问包围盒包含 rec.p 的节点
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+
+  size_t size() const { return lights.size() + infinite.size(); }
+
+private:
+  struct Node {
+    LightBounds lb;
+    uint32_t left = 0;
+    uint32_t right = 0;
+    int32_t light = -1; // 叶子节点：lights 中的下标；-1 表示内部节点
+  };
+
+  std::vector<std::shared_ptr<hittable>> lights;
+  std::vector<std::shared_ptr<hittable>> infinite;
+  std::vector<Node> nodes;
+  math::AliasTable power_table;
+  LightSampling mode;
+
+  uint32_t build(std::vector<uint32_t> &ids,
+                 const std::vector<LightBounds> &lbs, size_t start,
+                 size_t end);
+
+  // 选择光源树（而非某个无界光源）的概率
+  float tree_prob() const;
+
+  // 在 node 处走向左子树的概率
+  float left_prob(const Node &node, const Point3 &o) const;
+
+  // 叶子处的选择概率（prob 为到达该叶子的概率）
+  float select_prob(const Node &leaf, float prob) const;
+
+  void pdf_recursive(uint32_t idx, const Ray &r, float prob,
+                     float &sum) const;
+
+  void light_pdf_recursive(uint32_t idx, const Point3 &o, const Vec3 &v,
+                           const hit_record &rec, float prob,
+                           float &sum) const;
+};
+
+} // namespace tracer
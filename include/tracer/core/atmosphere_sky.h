@@ -0,0 +1,63 @@
+#pragma once
+#include "tracer/core/background.h"
+
+namespace tracer {
+
+// 单次散射的大气模型（瑞利散射 + 米氏散射，Nishita 方法）。
+// 构造时沿视线和太阳方向做一次光线步进，把天空辐亮度预计算到
+// (视线天顶角 x 相对太阳的方位角) 查找表中，渲染时只做一次双线性插值。
+// 太阳本体不在天空中，由 DistantLight 提供（见 sun_radiance）；
+// 地平线以下取地平线处的颜色，一般被海面等几何体挡住
+class AtmosphereSky : public LatLongBackground {
+public:
+  // sun_direction：指向太阳的方向；up：天顶方向；
+  // intensity：大气层外的太阳辐照度
+  AtmosphereSky(const Vec3 &sun_direction, const Vec3 &up = Vec3(0, 0, 1),
+                float intensity = 20.0f);
+
+  virtual Color value(const Ray &r) const override;
+
+  // 太阳方向改为与第一个平行光一致，并重新计算查找表
+  virtual void add_sun(std::shared_ptr<const geometry::DistantLight> sun)
+      override;
+
+  virtual void direction_to_uv(const Vec3 &d, float &u,
+                               float &v) const override;
+  virtual Vec3 uv_to_direction(float u, float v) const override;
+  virtual int cols() const override { return 2 * AZIMUTH_RES; }
+  virtual int rows() const override { return 2 * ZENITH_RES; }
+  virtual float luminance(int x, int y) const override;
+
+  // 角半径为 angular_radius（度）的太阳圆盘经大气衰减后的辐亮度，
+  // 与天空使用同一套散射参数
+  Color sun_radiance(float angular_radius) const;
+
+  const Vec3 &sun_direction() const { return sun_dir; }
+
+private:
+  // 查找表格点：天顶角 [0, pi/2] 和相对方位角 [0, pi]（关于太阳对称）
+  static constexpr int ZENITH_RES = 128;
+  static constexpr int AZIMUTH_RES = 128;
+
+  Vec3 sun_dir;
+  Vec3 up;
+  Vec3 sun_forward; // 太阳方向在水平面上的投影，方位角从这里起算
+  Vec3 sun_side;
+  float intensity;
+  std::vector<Color> lut; // (ZENITH_RES + 1) x (AZIMUTH_RES + 1)
+
+  void build_frame();
+  void build_lut();
+
+  // 大气中一点沿 dir 到大气层顶的透射率，被地球挡住时返回 0
+  Color transmittance(const Vec3 &p, const Vec3 &dir) const;
+
+  // 观察者沿 dir 看到的单次散射辐亮度
+  Color integrate(const Vec3 &dir) const;
+
+  const Color &lut_at(int zenith, int azimuth) const {
+    return lut[zenith * (AZIMUTH_RES + 1) + azimuth];
+  }
+};
+
+} // namespace tracer
@@ -2,12 +2,28 @@
 #include "opencv2/opencv.hpp"
 #include "tracer/core/ray.h"
 #include "tracer/math/math.h"
+#include "tracer/utils/mapped_file.h"
+#include <memory>
+#include <vector>
 
 namespace tracer {
 
+namespace geometry {
+class DistantLight;
+}
+
 class Background {
 public:
   virtual Color value(const Ray &r) const { return Color(0, 0, 0); };
+
+  // 加入天空中的平行光（太阳），同一个光源还需登记到 lights 中做光源采样
+  virtual void add_sun(std::shared_ptr<const geometry::DistantLight> sun);
+
+  // 光线逃逸时看到的总辐亮度：天空本身加上各个太阳圆盘
+  Color radiance(const Ray &r) const;
+
+protected:
+  std::vector<std::shared_ptr<const geometry::DistantLight>> suns;
 };
 
 // 物理大气背景（实时计算瑞利散射和米氏散射）
@@ -20,11 +36,36 @@ public:
   PhysicalSky(const Vec3 &sun_direction);
 
   virtual Color value(const Ray &r) const override;
+
+  // 太阳方向改为与平行光一致；太阳本体改由平行光的圆盘提供，
+  // 天空中只保留大范围的光晕
+  virtual void add_sun(std::shared_ptr<const geometry::DistantLight> sun)
+      override;
+
+private:
+  bool analytic_sun = false;
+};
+
+// 按经纬度参数化的背景，可以由 EnvironmentLight 按亮度做重要性采样。
+// (u, v) ∈ [0, 1)² 被 cols() x rows() 个双线性插值单元覆盖，
+// 单元 (i, j) 的四个角是格点 (i, j) ~ (i + 1, j + 1)
+class LatLongBackground : public Background {
+public:
+  // v 对应天顶角 theta / pi
+  virtual void direction_to_uv(const Vec3 &d, float &u, float &v) const = 0;
+  virtual Vec3 uv_to_direction(float u, float v) const = 0;
+
+  virtual int cols() const = 0;
+  virtual int rows() const = 0;
+
+  // 格点 (x, y) 的亮度
+  virtual float luminance(int x, int y) const = 0;
 };
 
-class ImageBackground : public Background {
+class ImageBackground : public LatLongBackground {
 public:
-  cv::Mat img;
+  cv::Mat img; // 可能直接指向 DecodedCache 映射的缓存文件，只读
+  std::shared_ptr<const utils::MappedFile> mapping;
   int width;
   int height;
   Vec3 vup;
@@ -35,6 +76,18 @@ public:
   ImageBackground(const std::string &, const Vec3 &, const Vec3 &);
 
   virtual Color value(const Ray &r) const override;
+
+  virtual void direction_to_uv(const Vec3 &d, float &u,
+                               float &v) const override;
+  virtual Vec3 uv_to_direction(float u, float v) const override;
+
+  // 格点即像素，width / height 为最大像素坐标
+  virtual int cols() const override { return img.empty() ? 0 : width; }
+  virtual int rows() const override { return img.empty() ? 0 : height; }
+  virtual float luminance(int x, int y) const override;
+
+  // 像素 (x, y) 的颜色（未乘曝光），坐标超出范围时取边缘
+  Color texel(int x, int y) const;
 };
 
 } // namespace tracer
\ No newline at end of file
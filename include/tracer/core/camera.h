@@ -4,14 +4,24 @@
 #include "tracer/core/hittable.h"
 #include "tracer/core/hittable_list.h"
 #include "tracer/core/material.h"
+#include "tracer/core/path_guide.h"
 #include "tracer/core/pdf.h"
+#include "tracer/core/photon_map.h"
+#include "tracer/core/radiance_cache.h"
 #include "tracer/core/ray.h"
 #include "tracer/math/math.h"
+#include "tracer/math/reservoir.h"
 #include <chrono>
 #include <omp.h>
 
 namespace tracer {
 
+// 直接光照的估计方式
+enum class DirectLighting {
+  MIS, // 一个光源样本与 BSDF 样本按功率启发式加权
+  RIS  // 多个候选按未遮挡贡献重采样，只对选中的样本做遮挡测试
+};
+
 class Camera {
 public:
   int image_width;
@@ -27,6 +37,23 @@ public:
   float vfov;
   float aspect_ratio;
 
+  DirectLighting direct_lighting = DirectLighting::MIS;
+  int ris_candidates = 8; // RIS 模式下每个着色点的光源候选数
+
+  // 路径引导的训练轮数，第 k 轮每像素 2^k 个样本，0 表示关闭
+  int guiding_passes = 0;
+
+  // 每轮发射的焦散光子数，0 表示关闭；开启后渲染分为若干轮，每轮重新
+  // 发射光子并缩小查询半径（渐进式光子映射）
+  int caustic_photons = 0;
+  float caustic_radius = 0.0f; // 第一轮的查询半径，0 表示自动估计
+
+  // 路径在第 radiance_cache_depth 次弹射落到漫反射表面时改为查询辐亮度
+  // 缓存并终止，0 表示关闭；缓存由更浅的顶点在渲染过程中填充
+  int radiance_cache_depth = 0;
+  float radiance_cache_cell = 0.0f; // 格子边长，0 表示场景对角线的 1/64
+  bool keep_radiance_cache = false; // 动画的多帧之间沿用缓存
+
   Camera();
 
   Camera(int image_width, int image_height, int samples_per_pixel,
@@ -44,6 +71,38 @@ public:
                   const hittable &world, const hittable &lights, int depth);
 
 private:
+  // 路径相对于焦散光子图的状态：Diffuse 表示上一次散射发生在非镜面表面，
+  // Caustic 表示此后只经过了镜面反射/折射。Caustic 状态下到达光源的
+  // 路径（L S+ D）已由光子图估计，不再重复计入
+  enum class PathState { Camera, Diffuse, Caustic };
+
+  // bsdf_pdf 为上一次非镜面散射方向的 BSDF 采样概率密度；
+  // 为 0 表示来自相机或镜面反射，此时命中的自发光不参与 MIS
+  Color ray_color(const Ray &r, const std::shared_ptr<Background> &background,
+                  const hittable &world, const hittable &lights, int depth,
+                  float bsdf_pdf, PathState state);
+
+  // 光源采样 + 遮挡测试的直接光照估计，已乘上功率启发式权重
+  Color sample_direct(const Ray &r, const hit_record &rec,
+                      const scatter_record &srec,
+                      const std::shared_ptr<Background> &background,
+                      const hittable &world, const hittable &lights);
+
+  // 重采样重要性采样（RIS）的直接光照估计：ris_candidates 个光源候选和
+  // 1 个 BSDF 候选按平衡启发式组合后流过蓄水池，覆盖 lights 能采到的
+  // 全部方向，因此这些方向上 BSDF 路径命中的自发光不再计入
+  Color sample_direct_ris(const Ray &r, const hit_record &rec,
+                          const scatter_record &srec,
+                          const std::shared_ptr<Background> &background,
+                          const hittable &world, const hittable &lights);
+
+  // 正式渲染前逐轮训练路径引导，训练轮的图像直接丢弃
+  void train_guide(const hittable &world, const hittable &lights);
+
+  std::shared_ptr<PathGuide> guide;
+  std::shared_ptr<PhotonMap> photons;
+  std::shared_ptr<RadianceCache> radiance_cache;
+
   Point3 origin;
   Point3 lower_left_corner;
   Vec3 horizontal;
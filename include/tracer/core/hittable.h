@@ -7,6 +7,7 @@
 namespace tracer {
 
 class Material;
+class hittable;
 
 struct hit_record {
   Point3 p;
@@ -20,6 +21,12 @@ struct hit_record {
   float triangle_area;
   Vec3 tangent;
   Vec3 bitangent;
+  // 命中的三角形所属的网格（其它图元不设置），光源 pdf 据此直接定位三角形
+  const hittable *object = nullptr;
+  // UV 面积与世界面积之比的平方根，由图元设置，0 表示不做纹理滤波
+  float uv_density = 0.0f;
+  // 光锥在 UV 空间覆盖的宽度，纹理据此选择 MIP 层，0 表示最高分辨率
+  float uv_footprint = 0.0f;
 
   void set_face_normal(const Ray &r, const Vec3 &outward_normal);
 };
@@ -37,7 +44,36 @@ public:
 
   virtual Vec3 random(const Vec3 &o) const { return Vec3(1.0f, 0.0f, 0.0f); }
 
+  // 光线 (o, v) 在场景中的最近交点为 rec 时，random(o) 采到该点的立体角 pdf。
+  // 与 pdf_value 不同，被遮挡的部分不计入；默认重新求交本物体，
+  // 交点与 rec 不是同一点时返回 0
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const;
+
+  // 物体中可以作为面光源采样的部分（例如网格中 Ke/map_Ke 自发光的三角形），
+  // 没有时返回 nullptr
+  virtual std::shared_ptr<hittable> light_source() const { return nullptr; }
+
   virtual void refit(float t0, float t1) {}
+
+  // 作为光源时的总功率估计（亮度 x 面积），用于按功率选择光源；
+  // 默认用材质的平均自发光和包围盒表面积的一半粗略估计
+  virtual float emitted_power() const;
+
+  // 单面发光时的法线方向锥：所有发光面法线与 axis 的夹角余弦不小于
+  // cos_theta_o，光只射向法线一侧的半球；返回 false 表示双面/各向发光
+  virtual bool emission_cone(Vec3 &axis, float &cos_theta_o) const {
+    return false;
+  }
+
+  // 在表面上按面积取一点，填写 rec 的 p、normal、mat_ptr 和纹理坐标，
+  // 返回面积 pdf；光子映射据此从面光源发射光子，不支持的形状返回 0
+  virtual float sample_surface(hit_record &rec) const { return 0.0f; }
+
+  // 从光源发射一个光子，flux 为其携带的功率（已除以采样概率）。
+  // scene 为场景包围盒，供平行光确定发射范围；默认在 sample_surface
+  // 取到的点上按余弦分布发射，不能发射时返回 false
+  virtual bool emit_photon(const AABB &scene, Ray &ray, Color &flux) const;
 };
 
 class FlipFace : public hittable {
@@ -59,6 +95,8 @@ public:
 
   virtual Vec3 random(const Vec3 &o) const override;
 
+  virtual float sample_surface(hit_record &rec) const override;
+
 public:
   std::shared_ptr<hittable> ptr;
 };
@@ -24,6 +24,16 @@ public:
 
   virtual Vec3 random(const Vec3 &o) const override;
 
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+
+  // 均匀选择一个物体，面积 pdf 相应除以物体个数
+  virtual float sample_surface(hit_record &rec) const override;
+
+  // 均匀选择一个光源发射光子
+  virtual bool emit_photon(const AABB &scene, Ray &ray,
+                           Color &flux) const override;
+
   virtual std::shared_ptr<Material> get_material() const override {
     return nullptr;
   }
@@ -10,6 +10,9 @@
 
 namespace tracer {
 
+// 背面剔除模式：材质为 Inherit 时沿用网格的设置
+enum class CullMode { Inherit, None, Back, Front };
+
 struct scatter_record {
   Ray specular_ray;
   bool is_specular;
@@ -28,6 +31,26 @@ public:
 
   virtual bool is_emitter() const { return false; }
 
+  // 参与介质中的散射（相函数），散射点不在表面上
+  virtual bool is_volumetric() const { return false; }
+
+  // 理想漫反射：出射辐亮度与观察方向无关，可以由辐亮度缓存代替
+  virtual bool is_diffuse() const { return false; }
+
+  // 自发光在表面上的平均值，只用于估计光源功率
+  virtual Color average_emission() const { return Color(0.0f, 0.0f, 0.0f); }
+
+  // alpha 镂空：has_alpha_cutout() 为 false 时求交阶段不会调用 alpha_test
+  virtual bool has_alpha_cutout() const { return false; }
+
+  // 返回 false 表示 (u, v) 处被镂空，求交时忽略这个命中并继续遍历
+  virtual bool alpha_test(float u, float v) const { return true; }
+
+  // UV 矩形内是否完全不透明，网格据此为每个三角形缓存不透明标记
+  virtual bool opaque_in_rect(float u0, float v0, float u1, float v1) const {
+    return true;
+  }
+
   virtual bool scatter(const Ray &r, const hit_record &rec,
                        scatter_record &srec) const = 0;
 
@@ -36,6 +59,9 @@ public:
                                const Ray &scattered) const {
     return 0.0f;
   }
+
+  // 三角网格在求交阶段按该模式剔除背面/正面（以顶点逆时针为正面）
+  CullMode cull_mode = CullMode::Inherit;
 };
 
 } // namespace tracer
\ No newline at end of file
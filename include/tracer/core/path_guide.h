@@ -0,0 +1,103 @@
+#pragma once
+#include "tracer/core/aabb.h"
+#include "tracer/core/pdf.h"
+#include "tracer/math/drand48.h"
+#include "tracer/math/math.h"
+#include <cstdint>
+#include <vector>
+
+namespace tracer {
+
+// 方向四叉树（D-tree）：单位球按等面积映射 (cos(theta), phi) 展开到
+// [0, 1]²，每个节点记录四个象限内入射辐亮度的累计值。
+// 能量集中的象限逐轮细分，能量很少的象限合并，采样与 pdf 查询都是
+// 从根到叶子的一次下降
+class DTree {
+public:
+  DTree();
+
+  // 多线程同时调用：只做原子累加，不改变树的结构
+  void record(const Vec3 &dir, float radiance);
+
+  float pdf(const Vec3 &dir) const;
+  Vec3 sample() const;
+
+  float total() const;
+
+  // 能量超过总量 threshold 的象限继续细分（已有子树沿用其统计，
+  // 叶子向下多分一层），其余合并为叶子；返回结构更新、统计清零的新树
+  DTree refined(float threshold, int max_depth) const;
+
+private:
+  struct Node {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    uint32_t child[4] = {0, 0, 0, 0}; // 0 表示该象限是叶子
+  };
+  std::vector<Node> nodes;
+
+  uint32_t build(DTree &out, int src, float energy, float min_energy,
+                 int depth, int max_depth) const;
+};
+
+// 实用路径引导（Müller 等人的 SD-tree）：场景包围盒上的空间二叉树，
+// 每个叶子带一棵方向四叉树，在若干轮训练中学习入射辐亮度的分布。
+// 一轮渲染内两种树的结构都只读，记录只做原子累加，多线程无需加锁；
+// 结构调整（refine）在两轮之间单线程完成
+class PathGuide {
+public:
+  // 引导分布在采样中所占的比例，其余仍按 BSDF 采样
+  static constexpr float GUIDE_FRACTION = 0.5f;
+
+  PathGuide(const AABB &bounds);
+
+  // 当前一轮记录的入射辐亮度估计（亮度 / 采样概率密度）
+  void record(const Point3 &p, const Vec3 &dir, float radiance);
+
+  // p 处的引导分布，还没有学到能量时返回 nullptr
+  std::shared_ptr<PDF> pdf(const Point3 &p) const;
+
+  // 一轮训练（每像素 pass_spp 个样本）结束：样本多的空间叶子一分为二，
+  // 本轮的统计成为下一轮的采样分布
+  void refine(int pass_spp);
+
+  bool can_sample() const { return iteration > 0; }
+
+  bool recording = true;
+
+private:
+  struct SpatialNode {
+    int axis = 0;
+    uint32_t child[2] = {0, 0}; // 都为 0 表示叶子
+    uint32_t leaf = 0;          // 叶子在 leaves 中的下标
+  };
+
+  struct Leaf {
+    DTree sampling; // 上一轮学到的分布，只读
+    DTree building; // 本轮正在累计的统计
+    uint32_t samples = 0;
+  };
+
+  AABB bounds;
+  std::vector<SpatialNode> nodes;
+  std::vector<Leaf> leaves;
+  int iteration = 0;
+
+  uint32_t leaf_index(const Point3 &p) const;
+};
+
+// 按 D-tree 采样方向
+class Guided_pdf : public PDF {
+public:
+  Guided_pdf(const DTree &tree) : tree(tree) {}
+
+  virtual float value(const Vec3 &direction) const override {
+    return tree.pdf(direction);
+  }
+
+  virtual Vec3 generate() const override { return tree.sample(); }
+
+private:
+  const DTree &tree;
+};
+
+} // namespace tracer
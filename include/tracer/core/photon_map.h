@@ -0,0 +1,48 @@
+#pragma once
+#include "tracer/core/aabb.h"
+#include "tracer/core/hittable.h"
+#include "tracer/core/material.h"
+#include "tracer/math/math.h"
+#include <cstdint>
+#include <vector>
+
+namespace tracer {
+
+// 焦散光子图：从光源发射光子，只保存经过至少一次镜面反射/折射后落到
+// 非镜面表面上的光子（L S+ D 路径），相机路径在非镜面表面上做密度估计。
+// 光子按哈希网格组织：格子边长为查询半径的两倍，一次查询最多访问
+// 2x2x2 个格子；建网格时按桶做计数排序，同一个桶的光子在内存中连续存放
+class PhotonMap {
+public:
+  // 发射 count 个光子并建立查询网格；radius <= 0 时按光子的分布估计半径
+  void build(const hittable &world, const hittable &lights,
+             const AABB &scene, int count, int max_depth, float radius);
+
+  // rec 处的 BSDF 对焦散光子做密度估计，得到反射的辐亮度
+  Color estimate(const Ray &r, const hit_record &rec,
+                 const scatter_record &srec) const;
+
+  float radius() const { return search_radius; }
+  size_t size() const { return photons.size(); }
+
+private:
+  struct Photon {
+    Point3 p;
+    Vec3 wi; // 指向光子射来的方向
+    Color flux;
+  };
+
+  std::vector<Photon> photons;
+  std::vector<uint32_t> cell_start; // 每个桶在 photons 中的起始位置
+  uint32_t mask = 0;
+  float search_radius = 0.0f;
+  float inv_cell = 0.0f;
+
+  void trace(const hittable &world, const hittable &lights, const AABB &scene,
+             int count, int max_depth);
+  void build_grid();
+
+  uint32_t bucket(int x, int y, int z) const;
+};
+
+} // namespace tracer
@@ -0,0 +1,45 @@
+#pragma once
+#include "tracer/math/vec3.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace tracer {
+
+// 世界空间的辐亮度缓存：按 (位置所在格子, 量化法线) 散列到固定大小的
+// 开放寻址表，每个格子累计漫反射表面上出射辐亮度与反照率之比
+// （即 E / pi），与纹理无关，取用时再乘上着色点的反照率。
+// 插入只用 CAS 占位、原子加累计，查询时逐个原子读取，多线程无锁且
+// 没有数据竞争。各分量与样本数不是一起读出的，并发更新时均值可能
+// 混入个别样本的部分分量，渲染中可以忽略
+class RadianceCache {
+public:
+  // 格子至少累计这么多样本才参与查询
+  static constexpr float MIN_SAMPLES = 16.0f;
+
+  explicit RadianceCache(float cell_size);
+
+  void record(const Point3 &p, const Vec3 &normal, const Color &value);
+
+  bool lookup(const Point3 &p, const Vec3 &normal, Color &value) const;
+
+  // 动画的下一帧沿用缓存时，旧统计按 keep 的比例保留，新样本逐渐取代它们
+  void decay(float keep);
+
+  float cell() const { return cell_size; }
+
+private:
+  struct Entry {
+    std::atomic<uint64_t> key{0}; // 0 表示空位
+    float sum[3] = {0.0f, 0.0f, 0.0f};
+    float count = 0.0f;
+  };
+
+  float cell_size;
+  std::vector<Entry> entries;
+
+  uint64_t make_key(const Point3 &p, const Vec3 &normal) const;
+};
+
+} // namespace tracer
@@ -1,5 +1,6 @@
 #pragma once
 #include "tracer/math/vec3.h"
+#include <cstdint>
 
 namespace tracer {
 
@@ -15,6 +16,12 @@ public:
   float time() const { return tm; }
 
   mutable int bvh_hit_count = 0;
+  mutable uint32_t bytes_touched = 0; // 网格遍历读取的字节数（统计用）
+
+  // 光锥：起点处的宽度与张角（弧度），距离 t 处的宽度为
+  // cone_width + cone_spread * t * |dir|，用于估计纹理查询的覆盖范围
+  float cone_width = 0.0f;
+  float cone_spread = 0.0f;
 
 private:
   Point3 orig;
@@ -7,6 +7,20 @@ namespace tracer {
 class Texture {
 public:
   virtual Color value(float u, float v, const Point3 &p) const = 0;
+
+  // footprint 为这次查询在 UV 空间覆盖的宽度（来自光锥），
+  // 默认忽略；图像纹理据此在 MIP 层之间插值
+  virtual Color sample(float u, float v, const Point3 &p,
+                       float footprint) const {
+    return value(u, v, p);
+  }
+
+  // UV 矩形内 x 分量的下界，用于预判 alpha 镂空区域，结果必须是保守的：
+  // 偏大会让带镂空的三角形被当作完全不透明而跳过 alpha 测试。
+  // 默认返回 0（不做预判）；纯色与图像纹理给出精确的下界
+  virtual float min_x_in_rect(float u0, float v0, float u1, float v1) const {
+    return 0.0f;
+  }
 };
 
 } // namespace tracer
\ No newline at end of file
@@ -25,6 +25,8 @@ public:
 
   virtual Vec3 random(const Point3 &origin) const override;
 
+  virtual float sample_surface(hit_record &rec) const override;
+
   virtual std::shared_ptr<Material> get_material() const override {
     return mat_ptr;
   }
@@ -51,6 +53,8 @@ public:
 
   virtual Vec3 random(const Point3 &origin) const override;
 
+  virtual float sample_surface(hit_record &rec) const override;
+
   virtual std::shared_ptr<Material> get_material() const override {
     return mat_ptr;
   }
@@ -77,6 +81,8 @@ public:
 
   virtual Vec3 random(const Point3 &origin) const override;
 
+  virtual float sample_surface(hit_record &rec) const override;
+
   virtual std::shared_ptr<Material> get_material() const override {
     return mat_ptr;
   }
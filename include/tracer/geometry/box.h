@@ -20,6 +20,11 @@ public:
 
   virtual Vec3 random(const Point3 &o) const override;
 
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+
+  virtual float sample_surface(hit_record &rec) const override;
+
   virtual std::shared_ptr<Material> get_material() const override;
 
   Point3 box_min;
@@ -0,0 +1,67 @@
+#pragma once
+#include "tracer/core/hittable.h"
+#include "tracer/core/onb.h"
+#include "tracer/math/drand48.h"
+#include "tracer/math/math.h"
+#include <algorithm>
+
+namespace tracer {
+namespace geometry {
+
+// 无穷远处的平行光（太阳），以有限角半径的圆盘出现在天空中。
+// 本身不参与求交，也没有包围盒：光线逃逸时由背景叠加圆盘内的辐亮度
+// （见 Background::add_sun），因此只需登记在 lights 中，不能加入 world。
+// 光源采样在圆盘对应的方向锥内均匀进行，pdf 为立体角的倒数
+class DistantLight : public hittable {
+public:
+  // direction：指向太阳的方向；angular_radius：圆盘角半径（度），
+  // 真实太阳约为 0.27；radiance：圆盘内的辐亮度
+  DistantLight(const Vec3 &direction, float angular_radius,
+               const Color &radiance);
+
+  virtual bool hit(const Ray &r, float t_min, float t_max,
+                   hit_record &rec) const override {
+    return false;
+  }
+
+  virtual bool bounding_box(float t0, float t1,
+                            AABB &output_box) const override {
+    return false;
+  }
+
+  virtual float pdf_value(const Point3 &o, const Vec3 &v) const override;
+
+  // 返回方向锥内足够远处的一点，阴影光线不被遮挡时会逃逸到背景
+  virtual Vec3 random(const Point3 &o) const override;
+
+  // 命中了场景中的表面说明光线没有到达无穷远处
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override {
+    return 0.0f;
+  }
+
+  // 垂直入射时的辐照度（辐亮度 x 立体角）
+  virtual float emitted_power() const override;
+
+  // 光子从垂直于太阳方向、覆盖整个场景包围球的圆盘上平行射入
+  virtual bool emit_photon(const AABB &scene, Ray &ray,
+                           Color &flux) const override;
+
+  // 方向 dir 上的辐亮度，圆盘之外为 0
+  Color Le(const Vec3 &dir) const;
+
+  const Vec3 &direction() const { return dir; }
+  float solid_angle() const {
+    return 2.0f * math::TRACER_PI * one_minus_cos_max;
+  }
+
+private:
+  Vec3 dir;
+  Color radiance;
+  float cos_max;
+  float one_minus_cos_max; // 小角度时直接用 1 - cos_max 精度不够
+  onb uvw;
+};
+
+} // namespace geometry
+} // namespace tracer
@@ -0,0 +1,50 @@
+#pragma once
+#include "tracer/core/background.h"
+#include "tracer/core/hittable.h"
+#include "tracer/math/alias_table.h"
+#include "tracer/math/drand48.h"
+
+namespace tracer {
+namespace geometry {
+
+// HDR 环境贴图、天空查找表等经纬度背景作为光源参与直接光照采样。
+// 构造时把背景划分成网格，按 亮度 x sin(theta) 建立边缘分布（行）和
+// 条件分布（行内各列）的别名表，采样与 pdf 查询都是 O(1)。
+// 与 DistantLight 一样位于无穷远处、没有包围盒，辐亮度由背景本身提供，
+// 因此只登记在 lights 中
+class EnvironmentLight : public hittable {
+public:
+  EnvironmentLight(std::shared_ptr<const LatLongBackground> background);
+
+  virtual bool hit(const Ray &r, float t_min, float t_max,
+                   hit_record &rec) const override {
+    return false;
+  }
+
+  virtual bool bounding_box(float t0, float t1,
+                            AABB &output_box) const override {
+    return false;
+  }
+
+  virtual float pdf_value(const Point3 &o, const Vec3 &v) const override;
+
+  virtual Vec3 random(const Point3 &o) const override;
+
+  // 命中了场景中的表面说明光线没有逃逸到背景
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override {
+    return 0.0f;
+  }
+
+  bool empty() const { return marginal.empty(); }
+
+private:
+  std::shared_ptr<const LatLongBackground> background;
+  int nu = 0; // 网格列数（对应 u / phi）
+  int nv = 0; // 网格行数（对应 v / theta）
+  math::AliasTable marginal;
+  std::vector<math::AliasTable> conditional;
+};
+
+} // namespace geometry
+} // namespace tracer
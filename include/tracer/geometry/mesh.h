@@ -2,7 +2,9 @@
 #include "tracer/accelerator/bvh.h"
 #include "tracer/core/hittable.h"
 #include "tracer/core/material.h"
+#include "tracer/math/packing.h"
 #include "tracer/math/vec2.h"
+#include <algorithm>
 #include <numeric>
 
 namespace tracer {
@@ -11,11 +13,48 @@ namespace geometry {
 struct alignas(16) Vertex {
   Vec3 vertex;
   Vec3 normal;
-  Vec3 tangent;   // 切线 (沿 U 方向)
-  Vec3 bitangent; // 副切线 (沿 V 方向)
+  Vec3 tangent;             // 切线 (沿 U 方向)
+  float tangent_sign = 1.0f; // 副切线手性：bitangent = sign * cross(n, t)
   Vec2 tex_coord;
 };
 
+// UV 面积与世界面积之比的平方根，光锥据此把命中点处的宽度换算到 UV 空间
+inline float uv_density(const Vertex &a, const Vertex &b, const Vertex &c) {
+  float area = 0.5f * cross(b.vertex - a.vertex, c.vertex - a.vertex).length();
+  Vec2 d1 = b.tex_coord - a.tex_coord;
+  Vec2 d2 = c.tex_coord - a.tex_coord;
+  float uv_area = 0.5f * std::fabs(d1.x() * d2.y() - d1.y() * d2.x());
+  return area > 0.0f ? std::sqrt(uv_area / area) : 0.0f;
+}
+
+// 压缩顶点（24 字节）：位置保持 float，法线/切线八面体编码，UV 半精度
+struct CompactVertex {
+  Vec3 vertex;
+  uint32_t normal;  // 八面体编码 16:16
+  uint32_t tangent; // 八面体编码 16:15 + 手性符号位
+  uint16_t tex_coord[2];
+};
+
+enum class VertexFormat {
+  Full,   // Vertex，48 字节
+  Compact // CompactVertex，24 字节
+};
+
+// 求交专用的三角形数据（热数据流）：按 BVH 叶子顺序连续存放，
+// 遍历时只读取这里，着色属性（Vertex）只在最终命中后访问一次。
+// 每 4 个三角形一组按 SoA 排列，一条 SSE 指令同时测试 4 个三角形，
+// 不足 4 个的空位填退化三角形（e1 = e2 = 0），永远不会命中
+struct alignas(16) TriBlock4 {
+  float v0[3][4];
+  float e1[3][4]; // v1 - v0
+  float e2[3][4]; // v2 - v0
+  uint8_t alpha_mask = 0; // 需要 alpha 测试的通道（非完全不透明的镂空三角形）
+  uint8_t cull_back = 0;  // 剔除背面命中的通道
+  uint8_t cull_front = 0; // 剔除正面命中的通道
+};
+
+class MeshCache;
+
 class Mesh : public hittable, public std::enable_shared_from_this<Mesh> {
 public:
   std::vector<Vertex> vertices;
@@ -23,6 +62,30 @@ public:
   std::vector<uint32_t> material_indices;
   std::vector<std::shared_ptr<Material>> materials;
 
+  // 压缩存储，finalize() 时按 vertex_format / compact_indices 生成，
+  // 生成后对应的 vertices / indices 会被释放
+  std::vector<CompactVertex> compact_vertices;
+  std::vector<uint16_t> indices16;
+  VertexFormat vertex_format = VertexFormat::Full;
+  bool compact_indices = false; // 顶点数不超过 65536 时使用 16 位索引
+
+  // 网格默认的剔除模式，材质的 cull_mode 不为 Inherit 时以材质为准；
+  // 在 finalize() 之前设置
+  CullMode cull_mode = CullMode::None;
+
+  // 非 0 时 finalize() 完成后把结果写入 MeshCache，下次加载直接读取
+  uint64_t cache_key = 0;
+
+  // 最近一次 finalize() 各阶段的用时（秒），从缓存载入时均为 0
+  struct FinalizeTimes {
+    double bounds = 0.0;
+    double normals = 0.0;
+    double tangents = 0.0;
+    double area_cdf = 0.0;
+    double bvh = 0.0;
+  };
+  FinalizeTimes finalize_times;
+
   std::vector<float> tri_area; // 每个三角形的面积
   std::vector<float> tri_cdf;  // 累积面积（长度为 triangle_count+1）
   float total_area = 0.0f;
@@ -34,9 +97,11 @@ public:
     uint32_t start = 0; // 叶子节点：三角形起始索引（在 tri_indices 中）
     uint32_t count = 0; // 叶子节点：三角形数量（0 表示内部节点）
     uint32_t axis = 0;
+    uint32_t block = 0; // 叶子节点：第一个 TriBlock4 的索引
   };
   std::vector<BVHNode> nodes;
   std::vector<uint32_t> tri_indices;
+  std::vector<TriBlock4> tri_blocks; // 叶子 i 占用 ceil(count / 4) 个块
 
   Mesh() {}
 
@@ -55,21 +120,59 @@ public:
 
   virtual Vec3 random(const Vec3 &o) const override;
 
+  // rec 来自本网格时直接用三角形的几何法线计算，不重新求交
+  virtual float light_pdf(const Vec3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+
+  // Ke / map_Ke 自发光三角形组成的 MeshLight，需在 finalize() 之后调用
+  virtual std::shared_ptr<hittable> light_source() const override;
+
+  // 与存储格式无关的访问接口
+  uint32_t index_at(size_t i) const {
+    return indices16.empty() ? indices[i] : indices16[i];
+  }
+  Vec3 position(uint32_t i) const {
+    return compact_vertices.empty() ? vertices[i].vertex
+                                    : compact_vertices[i].vertex;
+  }
+  Vertex fetch_vertex(uint32_t i) const;
+  Vec3 geometric_normal(uint32_t tri) const {
+    Vec3 v0 = position(index_at(tri * 3));
+    return normalize(cross(position(index_at(tri * 3 + 1)) - v0,
+                           position(index_at(tri * 3 + 2)) - v0));
+  }
+  size_t vertex_count() const {
+    return std::max(vertices.size(), compact_vertices.size());
+  }
+  size_t triangle_count() const {
+    return std::max(indices.size(), indices16.size()) / 3;
+  }
+  size_t vertex_stride() const {
+    return compact_vertices.empty() ? sizeof(Vertex) : sizeof(CompactVertex);
+  }
+
   void compute_smooth_normals();
   void compute_tangents();
   void finalize();
   void build_bvh();
   void refit_blas();
 
+  // 打印热/冷数据流的内存占用（包括当前顶点/索引格式）
+  void print_memory_stats() const;
+
 private:
+  friend class MeshCache;
+
   AABB bbox;
+  bool cached = false; // 由 MeshCache 载入，BVH 和面积表已经就绪
 
   void build_area_cdf();
   void refit_bvh();
   void refit_recursive(uint32_t node_idx);
-  static bool ray_triangle_intersect(const Ray &r, const Vec3 &v0,
-                                     const Vec3 &v1, const Vec3 &v2, float &t,
-                                     float &u, float &v);
+  void build_tri_blocks();
+  void update_tri_blocks();
+  void compact_storage();
+  bool alpha_pass(uint32_t tri, float b1, float b2) const;
 };
 
 } // namespace geometry
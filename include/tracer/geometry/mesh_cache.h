@@ -0,0 +1,46 @@
+#pragma once
+#include "tracer/geometry/mesh.h"
+#include <mutex>
+#include <string>
+
+namespace tracer {
+namespace geometry {
+
+// 网格几何的二进制缓存：顶点、索引、材质下标以及 finalize() 的结果
+// （平滑法线与切线、面积表、BVH 节点和三角形顺序）按固定格式写入一个
+// 文件。再次加载同一模型时映射该文件直接拷贝到网格中，跳过 OBJ 解析、
+// 顶点去重和 BVH 构建。
+// 键为源文件内容、缓存格式版本和相关结构体大小的散列，任何一项变化后
+// 旧文件自动失效。依赖材质和存储格式的数据（TriBlock4 的剔除与 alpha
+// 标记、压缩顶点）每次加载后重新生成，不写入缓存
+class MeshCache {
+public:
+  static MeshCache &instance();
+
+  // 缓存目录，默认为当前用户私有的 meshes 目录（见 utils::user_cache_dir）；
+  // 传入空串关闭缓存
+  void set_directory(const std::string &dir);
+  bool enabled() const;
+
+  // 在 seed 的基础上加入格式版本和结构体大小，得到缓存的键
+  static uint64_t key(uint64_t seed);
+
+  // 命中时填充网格并返回 true，之后的 finalize() 只生成 TriBlock4 和
+  // 压缩存储。数量或下标（顶点、三角形、BVH 子节点、材质下标须小于
+  // material_count）不一致的文件视为未命中，网格保持不变
+  bool load(uint64_t key, uint32_t material_count, Mesh &mesh) const;
+
+  // 写入已经 finalize() 但尚未压缩存储的网格
+  void store(uint64_t key, const Mesh &mesh) const;
+
+private:
+  MeshCache();
+
+  std::string path(uint64_t key) const;
+
+  mutable std::mutex mutex;
+  std::string dir;
+};
+
+} // namespace geometry
+} // namespace tracer
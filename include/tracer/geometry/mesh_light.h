@@ -0,0 +1,55 @@
+#pragma once
+#include "tracer/geometry/mesh.h"
+#include "tracer/math/alias_table.h"
+
+namespace tracer {
+namespace geometry {
+
+// 网格中自发光（Ke / map_Ke）三角形组成的面光源。
+// 按三角形功率（平均自发光亮度 x 面积）建别名表，O(1) 选取三角形；
+// light_pdf 直接由命中记录里的三角形编号计算，不需要重新求交。
+// 需要在网格 finalize() 之后构造，一般通过 Mesh::light_source() 获得
+class MeshLight : public hittable {
+public:
+  MeshLight(std::shared_ptr<const Mesh> mesh);
+
+  bool empty() const { return emissive.empty(); }
+  size_t triangle_count() const { return emissive.size(); }
+
+  virtual bool hit(const Ray &r, float t_min, float t_max,
+                   hit_record &rec) const override;
+
+  virtual bool bounding_box(float t0, float t1,
+                            AABB &output_box) const override;
+
+  virtual float pdf_value(const Point3 &o, const Vec3 &v) const override;
+
+  virtual Vec3 random(const Point3 &o) const override;
+
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+
+  virtual float emitted_power() const override { return power; }
+
+  virtual bool emission_cone(Vec3 &axis, float &cos_theta_o) const override;
+
+  virtual float sample_surface(hit_record &rec) const override;
+
+private:
+  static constexpr uint32_t NOT_EMISSIVE = 0xffffffffu;
+
+  std::shared_ptr<const Mesh> mesh;
+  std::vector<uint32_t> emissive;    // 自发光三角形编号
+  std::vector<uint32_t> light_index; // 三角形编号 -> emissive 下标
+  math::AliasTable table;
+  AABB bbox;
+  float power = 0.0f;
+
+  // 所有自发光三角形都只有一面可见时的法线方向锥
+  bool one_sided = false;
+  Vec3 cone_axis;
+  float cone_cos = -1.0f;
+};
+
+} // namespace geometry
+} // namespace tracer
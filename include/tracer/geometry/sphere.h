@@ -27,6 +27,8 @@ public:
 
   virtual Vec3 random(const Point3 &o) const override;
 
+  virtual float sample_surface(hit_record &rec) const override;
+
   Point3 center;
   float radius;
   std::shared_ptr<Material> mat_ptr;
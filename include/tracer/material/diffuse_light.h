@@ -12,6 +12,10 @@ public:
 
   virtual bool is_emitter() const override { return true; }
 
+  virtual Color average_emission() const override {
+    return emit->value(0.5f, 0.5f, Point3(0.0f, 0.0f, 0.0f));
+  }
+
   virtual bool scatter(const Ray &r_in, const hit_record &rec,
                        scatter_record &srec) const override;
 
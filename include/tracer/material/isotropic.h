@@ -13,6 +13,8 @@ public:
 
   virtual bool is_emitter() const override { return false; }
 
+  virtual bool is_volumetric() const override { return true; }
+
   virtual bool scatter(const Ray &r_in, const hit_record &rec,
                        scatter_record &srec) const override;
 
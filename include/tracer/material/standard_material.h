@@ -28,6 +28,20 @@ public:
     return emissive_map->value(rec.u, rec.v, rec.p);
   }
 
+  virtual Color average_emission() const override {
+    return emissive_map ? emissive_map->value(0.5f, 0.5f, Vec3(0, 0, 0))
+                        : Color(0.0f, 0.0f, 0.0f);
+  }
+
+  virtual bool has_alpha_cutout() const override {
+    return alpha_map != nullptr;
+  }
+
+  virtual bool alpha_test(float u, float v) const override;
+
+  virtual bool opaque_in_rect(float u0, float v0, float u1,
+                              float v1) const override;
+
   virtual bool scatter(const Ray &r_in, const hit_record &rec,
                        scatter_record &srec) const override;
 
@@ -69,7 +83,8 @@ public:
 
   // 透明/透射属性 (对应 mtl 的 d / Tr / Ni)
   float alpha{1.0f};
-  float ior{1.5f}; // 折射率 Ni
+  float alpha_cutoff{0.5f}; // alpha_map 低于该值的区域视为镂空
+  float ior{1.5f};          // 折射率 Ni
   bool double_sided = false;
 };
 
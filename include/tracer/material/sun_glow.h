@@ -13,6 +13,8 @@ public:
   Color emitted(const Ray &r_in, const hit_record &rec, float u, float v,
                 const Point3 &p) const override;
 
+  Color average_emission() const override { return glow_color * intensity; }
+
   bool scatter(const Ray &r_in, const hit_record &rec,
                scatter_record &srec) const override;
 
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tracer {
+namespace math {
+
+// Walker/Vose 别名表：按权重 O(1) 采样离散分布，O(1) 查询概率
+class AliasTable {
+public:
+  AliasTable() = default;
+  explicit AliasTable(const std::vector<float> &weights);
+
+  // u 为 [0, 1) 均匀随机数，返回采样到的下标
+  uint32_t sample(float u) const;
+
+  float pmf(uint32_t i) const { return pmf_[i]; }
+  size_t size() const { return bins.size(); }
+  bool empty() const { return bins.empty(); }
+
+private:
+  struct Bin {
+    float q = 1.0f;     // 留在本格的概率
+    uint32_t alias = 0; // 否则跳到的下标
+  };
+  std::vector<Bin> bins;
+  std::vector<float> pmf_;
+};
+
+} // namespace math
+} // namespace tracer
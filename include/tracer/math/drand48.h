@@ -32,22 +32,28 @@ inline float random_float() {
 }
 
 // 指定范围的随机数
+// 分布对象是 thread_local 的，区间必须每次通过 param_type 传入，
+// 否则会一直沿用该线程第一次调用时的区间
 inline float random_float(float min, float max) {
-  static thread_local std::uniform_real_distribution<float> distribution(min,
-                                                                         max);
-  return distribution(RandomEngine::get_instance());
+  using dist_t = std::uniform_real_distribution<float>;
+  static thread_local dist_t distribution;
+  return distribution(RandomEngine::get_instance(),
+                      dist_t::param_type(min, max));
 }
 
 // 正态分布
 inline float normal_dist(float mean, float stddev) {
-  static thread_local std::normal_distribution<float> distribution(mean,
-                                                                   stddev);
-  return distribution(RandomEngine::get_instance());
+  using dist_t = std::normal_distribution<float>;
+  static thread_local dist_t distribution;
+  return distribution(RandomEngine::get_instance(),
+                      dist_t::param_type(mean, stddev));
 }
 
 inline int random_int(int min, int max) {
-  static thread_local std::uniform_int_distribution<int> distribution(min, max);
-  return distribution(RandomEngine::get_instance());
+  using dist_t = std::uniform_int_distribution<int>;
+  static thread_local dist_t distribution;
+  return distribution(RandomEngine::get_instance(),
+                      dist_t::param_type(min, max));
 }
 
 } // namespace math
@@ -0,0 +1,24 @@
+#pragma once
+#include "tracer/math/vec3.h"
+#include <cstdint>
+
+namespace tracer {
+namespace math {
+
+// 八面体编码：单位向量 -> 2 x 16 位 snorm
+uint32_t oct_encode(const Vec3 &n);
+
+Vec3 oct_decode(uint32_t packed);
+
+// 切线八面体编码：16 位 x + 15 位 y，最高位保存副切线的手性符号
+uint32_t oct_encode_tangent(const Vec3 &t, float sign);
+
+Vec3 oct_decode_tangent(uint32_t packed, float &sign);
+
+// IEEE 754 半精度浮点转换
+uint16_t float_to_half(float f);
+
+float half_to_float(uint16_t h);
+
+} // namespace math
+} // namespace tracer
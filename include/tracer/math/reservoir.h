@@ -0,0 +1,30 @@
+#pragma once
+
+namespace tracer {
+namespace math {
+
+// 加权蓄水池采样：流式地读入候选样本，只保留一个，
+// 每个候选被保留的概率与其权重成正比
+template <typename T> struct Reservoir {
+  T y{};
+  float w_sum = 0.0f;
+  int M = 0;
+
+  // u 为 [0, 1) 均匀随机数；返回 true 表示候选替换了当前样本
+  bool update(const T &x, float w, float u) {
+    ++M;
+    if (!(w > 0.0f))
+      return false;
+    w_sum += w;
+    if (u * w_sum < w) {
+      y = x;
+      return true;
+    }
+    return false;
+  }
+
+  bool empty() const { return !(w_sum > 0.0f); }
+};
+
+} // namespace math
+} // namespace tracer
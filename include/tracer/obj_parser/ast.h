@@ -35,6 +35,7 @@ struct MaterialParams {
   Vec3 Tf;                // Transmission filter - 透射滤镜颜色
   int illum = 2;          // 光照模型
   float sharpness = 0.0f; // 反射贴图清晰度
+  std::string cull;       // 剔除模式（扩展）：none / back / front
 
   // 标准纹理贴图
   std::string map_Kd;   // 漫反射纹理
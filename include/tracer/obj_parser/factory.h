@@ -1,9 +1,15 @@
 #pragma once
+#include "tracer/geometry/mesh_cache.h"
 #include "tracer/material/standard_material.h"
-#include "tracer/texture/image_texture.h"
+#include "tracer/texture/texture_cache.h"
 #include "tracer/obj_parser/ast.h"
 #include "tracer/obj_parser/lexer.h"
+#include "tracer/obj_parser/obj_reader.h"
 #include "tracer/obj_parser/parser.h"
+#include "tracer/utils/asset_pipeline.h"
+#include "tracer/utils/content_hash.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
@@ -14,18 +20,28 @@ namespace obj_parser {
 class Object {
 public:
   Object() {}
-  Object(const std::string &);
+  // cull 为网格默认的剔除模式，双面/透射/镂空材质始终不剔除
+  Object(const std::string &, CullMode cull = CullMode::None);
 
   std::shared_ptr<geometry::Mesh> take();
 
+  // 加载各阶段的用时（秒）：OBJ 解析、顶点去重
+  double parse_seconds = 0.0;
+  double dedup_seconds = 0.0;
+
 private:
   std::string dir;
-  std::string source;
-  ObjParser o_parser;
+  ObjGeometry raw;
   ObjParser mtl_parser;
+  Value mtl_value;
+  std::unordered_map<std::string, uint32_t> mat_map;
   std::shared_ptr<geometry::Mesh> mesh;
 
-  void builder();
+  // 以下三步由 AssetPipeline 调度：材质库解析完成后，材质与几何数据
+  // 并行构建，贴图在各自的任务中解码
+  void parse_materials(const std::vector<std::string> &names);
+  void build_geometry();
+  void build_materials();
 };
 
 } // namespace obj_parser
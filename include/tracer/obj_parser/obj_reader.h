@@ -0,0 +1,50 @@
+#pragma once
+#include "tracer/math/vec2.h"
+#include "tracer/math/vec3.h"
+#include "tracer/obj_parser/ast.h"
+#include "tracer/utils/mapped_file.h"
+#include <string>
+#include <vector>
+
+namespace tracer {
+namespace obj_parser {
+
+// 从 OBJ 读出的几何数据。索引从 1 开始（负索引已经换算成正的），
+// 0 表示该属性缺省
+struct ObjGeometry {
+  std::vector<Vec3> positions;
+  std::vector<Vec2> uvs;
+  std::vector<Vec3> normals;
+  std::vector<Index> corners; // 每个三角形 3 个角，各为 (v, vt, vn)
+  // 每个三角形的材质名在 material_names 中的下标，NO_MATERIAL 表示
+  // 之前没有出现过 usemtl
+  std::vector<uint32_t> face_materials;
+  std::vector<std::string> material_names;
+
+  static constexpr uint32_t NO_MATERIAL = 0xffffffffu;
+};
+
+// 流式 OBJ 读取：文件整体内存映射，按行边界切成若干块并行解析，
+// 不经过词法单元和语法树。第一遍统计每块的顶点、纹理坐标、法线和
+// 三角形数量，前缀和得到各块的写入位置后，第二遍直接解析到最终数组里，
+// 额外内存只有几何数据本身。支持任意边数的多边形（扇形三角化）、
+// v / v/vt / v//vn / v/vt/vn 各种面格式以及负索引
+class ObjReader {
+public:
+  explicit ObjReader(const std::string &path);
+
+  bool ok() const { return !file.empty(); }
+  const char *data() const { return file.data(); }
+  size_t size() const { return file.size(); }
+
+  // 文件中 mtllib 引用的材质库
+  std::vector<std::string> mtllibs() const;
+
+  void read(ObjGeometry &out) const;
+
+private:
+  utils::MappedFile file;
+};
+
+} // namespace obj_parser
+} // namespace tracer
@@ -34,6 +34,7 @@ enum class TokenType {
   EMISSION_COLOR,
   ILLUMINATION_MODEL,
   SHARPNESS,
+  CULL,
 
   MAP_KD,
   MAP_KS,
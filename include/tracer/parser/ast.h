@@ -3,6 +3,8 @@
 #include "tracer/core/hittable.h"
 #include "tracer/geometry/aarect.h"
 #include "tracer/geometry/box.h"
+#include "tracer/geometry/distant_light.h"
+#include "tracer/geometry/environment_light.h"
 #include "tracer/geometry/heart.h"
 #include "tracer/geometry/ocean.h"
 #include "tracer/geometry/sphere.h"
@@ -13,7 +15,7 @@
 #include "tracer/material/water.h"
 #include "tracer/math/vec3.h"
 #include "tracer/obj_parser/factory.h"
-#include "tracer/texture/image_texture.h"
+#include "tracer/texture/texture_cache.h"
 #include "tracer/transform/rotate.h"
 #include "tracer/transform/translate.h"
 #include "tracer/volume/constant_medium.h"
@@ -26,6 +28,7 @@ namespace parser {
 
 struct Environment;
 struct ASTNode;
+class MeshNode;
 
 struct Quaternion {
   float x;
@@ -156,6 +159,8 @@ struct Statement {
 class Auroric {
 public:
   std::vector<Statement> program;
+  // 场景中出现的所有 Mesh 节点，求值前预先提交加载任务
+  std::vector<std::shared_ptr<MeshNode>> meshes;
 };
 
 struct Environment : public std::enable_shared_from_this<Environment> {
@@ -167,6 +172,7 @@ struct Environment : public std::enable_shared_from_this<Environment> {
 
   void set_environment(const std::string &, BasicType);
   BasicType get(const std::string &);
+  bool has(const std::string &) const;
 };
 
 class LambdaNode : public ASTNode {
@@ -395,6 +401,17 @@ public:
   virtual BasicType evaluate(std::shared_ptr<Environment> env) override;
 };
 
+class SunNode : public ASTNode {
+private:
+  std::shared_ptr<ASTNode> direction_expr, angle_expr, radiance_expr;
+
+public:
+  SunNode(std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>,
+          std::shared_ptr<ASTNode>);
+
+  virtual BasicType evaluate(std::shared_ptr<Environment> env) override;
+};
+
 class HeartNode : public ASTNode {
 private:
   std::shared_ptr<ASTNode> center_expr, rho_expr, material_expr, rot_expr;
@@ -423,11 +440,23 @@ public:
 
 class MeshNode : public ASTNode {
 private:
-  std::shared_ptr<ASTNode> model_path_expr, position_expr, rot_expr;
+  std::shared_ptr<ASTNode> model_path_expr, position_expr, rot_expr,
+      cull_expr;
+
+  // prefetch() 提交的加载任务及其参数
+  std::string pending_path;
+  CullMode pending_cull = CullMode::None;
+  utils::AssetPipeline::Job<std::shared_ptr<geometry::Mesh>> pending;
+
+  CullMode cull_mode(std::shared_ptr<Environment> env);
 
 public:
   MeshNode(std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>,
-           std::shared_ptr<ASTNode>);
+           std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>);
+
+  // 在后台加载模型并构建 BVH，evaluate() 时直接取结果；
+  // 路径依赖尚未求值的变量时什么也不做，留给 evaluate() 同步加载
+  void prefetch(std::shared_ptr<Environment> env);
 
   virtual BasicType evaluate(std::shared_ptr<Environment> env) override;
 };
@@ -44,6 +44,7 @@ private:
   std::shared_ptr<ASTNode> parse_yzrect();
   std::shared_ptr<ASTNode> parse_box();
   std::shared_ptr<ASTNode> parse_sphere();
+  std::shared_ptr<ASTNode> parse_sun();
   std::shared_ptr<ASTNode> parse_heart();
   std::shared_ptr<ASTNode> parse_ocean();
   std::shared_ptr<ASTNode> parse_mesh();
@@ -27,6 +27,7 @@ enum class TokenType {
   YZRectType,
   BoxType,
   SphereType,
+  SunType,
   HeartType,
   OceanType,
   MeshType,
@@ -0,0 +1,50 @@
+#pragma once
+#include "opencv2/opencv.hpp"
+#include "tracer/texture/tiled_image.h"
+#include "tracer/utils/mapped_file.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tracer {
+namespace texture {
+
+// 解码结果的磁盘缓存：图片解码后的像素按渲染时使用的格式写入缓存目录，
+// 以后的进程直接映射缓存文件，不再经过 imread。
+// 键为源文件内容的散列，源文件改变后旧的缓存自动失效。
+// 图像纹理缓存完整的 MIP 链（8 位 RGBA 分块，见 TiledImage），
+// 背景图片缓存按原始位深解码的像素（HDR 为 32 位浮点 BGR）
+class DecodedCache {
+public:
+  static DecodedCache &instance();
+
+  // 缓存目录，默认为当前用户私有的 textures 目录（见
+  // utils::user_cache_dir）；传入空串关闭缓存
+  void set_directory(const std::string &dir);
+  bool enabled() const;
+
+  // 图像纹理的 MIP 链，命中时各层直接指向映射的缓存文件；
+  // 源图片无法解码时返回空
+  std::vector<TiledImage> mip_chain(const std::string &path) const;
+
+  // 背景图片的像素，命中时返回的 Mat 直接指向映射的缓存文件（只读），
+  // mapping 负责保持映射；源图片无法解码时返回空 Mat
+  cv::Mat image(const std::string &path,
+                std::shared_ptr<const utils::MappedFile> &mapping) const;
+
+private:
+  DecodedCache();
+
+  enum class Kind : uint32_t { MipChain = 1, Image = 2 };
+
+  // 缓存文件的路径，缓存关闭或源文件不存在时为空
+  std::string cache_path(const std::string &source, Kind kind,
+                         uint64_t &key) const;
+
+  mutable std::mutex mutex;
+  std::string dir;
+};
+
+} // namespace texture
+} // namespace tracer
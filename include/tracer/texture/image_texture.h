@@ -1,18 +1,34 @@
 #pragma once
 #include "tracer/core/texture.h"
+#include "tracer/texture/tiled_image.h"
 
 namespace tracer {
 namespace texture {
 
+// 加载时生成 MIP 金字塔（逐级 2x2 盒式滤波），sample() 按查询的覆盖
+// 宽度在相邻两层之间做三线性插值：缩小的纹理读取落在小而常驻缓存的
+// 低分辨率层上，也不会因为随机跳读原图而产生走样。
+// 各层都以分块的 8 位 RGBA 存储（见 TiledImage），解码和 MIP 生成的结果
+// 经 DecodedCache 缓存在磁盘上
 class ImageTexture : public Texture {
 public:
   ImageTexture(const char *filepath);
 
   virtual Color value(float u, float v, const Point3 &p) const override;
 
+  virtual Color sample(float u, float v, const Point3 &p,
+                       float footprint) const override;
+
+  virtual float min_x_in_rect(float u0, float v0, float u1,
+                              float v1) const override;
+
+  // 解码后的像素（含 MIP 层）占用的内存
+  size_t bytes() const;
+
 private:
   int width, height;
-  cv::Mat image;
+  TiledImage image;
+  std::vector<TiledImage> mips; // 第 1 层起的 MIP 层，逐级减半
 };
 
 } // namespace texture
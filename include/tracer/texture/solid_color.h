@@ -13,6 +13,11 @@ public:
 
   virtual Color value(float u, float v, const Vec3 &p) const override;
 
+  virtual float min_x_in_rect(float u0, float v0, float u1,
+                              float v1) const override {
+    return color_value.x();
+  }
+
 private:
   Color color_value;
 };
@@ -0,0 +1,59 @@
+#pragma once
+#include "tracer/core/texture.h"
+#include "tracer/texture/tile_cache.h"
+#include <string>
+
+namespace tracer {
+namespace texture {
+
+// 按需加载的图像纹理：构造时只读取页表，像素在第一次被访问时才从磁盘
+// 读入 TileCache，内存占用受缓存预算约束而与场景引用的贴图总量无关。
+// 源图片第一次使用时转换成分页文件（.rtt，含 MIP 层，每页 64x64 个
+// 8 位 RGBA 像素）写入 cache_dir，源文件的大小或修改时间变化时重新生成。
+// 取样结果与 ImageTexture 一致。源图片无法读取或分页文件无法生成时
+// empty() 为 true，由调用方改用整张加载（见 TextureCache::load）
+class StreamedTexture : public Texture {
+public:
+  static constexpr int PAGE = 64;
+
+  StreamedTexture(const std::string &filepath, const std::string &cache_dir);
+  ~StreamedTexture();
+
+  StreamedTexture(const StreamedTexture &) = delete;
+  StreamedTexture &operator=(const StreamedTexture &) = delete;
+
+  virtual Color value(float u, float v, const Point3 &p) const override;
+
+  virtual Color sample(float u, float v, const Point3 &p,
+                       float footprint) const override;
+
+  virtual float min_x_in_rect(float u0, float v0, float u1,
+                              float v1) const override;
+
+  bool empty() const { return levels.empty(); }
+
+private:
+  struct Level {
+    int width, height;
+    int pages_x;
+    uint32_t first_page; // 本层第一页在文件中的序号
+  };
+
+  std::string path;
+  std::vector<Level> levels;
+  uint64_t data_offset = 0;
+  uint32_t id = 0;
+  intptr_t file = -1; // 平台相关的文件句柄
+
+  bool open_pages(const std::string &tiled_path, uint64_t source_size,
+                  int64_t source_time);
+
+  TileCache::PagePtr page(uint32_t index) const;
+
+  uint32_t texel(const Level &level, int x, int y) const;
+
+  Color bilinear(const Level &level, float u, float v) const;
+};
+
+} // namespace texture
+} // namespace tracer
@@ -0,0 +1,50 @@
+#pragma once
+#include "tracer/texture/image_texture.h"
+#include "tracer/texture/streamed_texture.h"
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tracer {
+namespace texture {
+
+// 进程级的图像纹理缓存：同一个文件只解码一次，之后按路径返回共享的
+// 纹理对象。不同文件可以在多个线程中同时解码，同一个文件的并发请求
+// 等待第一个请求的结果。
+// 开启按需加载后返回 StreamedTexture，像素由 TileCache 在预算内调度
+class TextureCache {
+public:
+  static TextureCache &instance();
+
+  std::shared_ptr<Texture> load(const std::string &path);
+
+  // 之后加载的纹理改为按需加载，budget 为所有纹理页共享的内存上限，
+  // 分页文件写到 cache_dir（默认为当前用户私有的 tiles 目录，见
+  // utils::user_cache_dir；该目录不可用时不开启按需加载）
+  void enable_streaming(size_t budget, const std::string &cache_dir = "");
+
+  // 打印缓存中不同图片的数量、占用内存以及命中次数；
+  // 按需加载时另外打印分页缓存的统计
+  void report() const;
+
+  size_t size() const;
+  size_t bytes() const;
+
+  // 释放缓存持有的引用，已经交给材质的纹理不受影响
+  void clear();
+
+private:
+  TextureCache() = default;
+
+  using Handle = std::shared_future<std::shared_ptr<Texture>>;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, Handle> textures;
+  size_t requests = 0;
+  bool streaming = false;
+  std::string tile_dir;
+};
+
+} // namespace texture
+} // namespace tracer
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tracer {
+namespace texture {
+
+// 按需加载纹理的页缓存：所有 StreamedTexture 的页共享一份内存预算，
+// 超出时按 LRU 淘汰。表分成若干分片，各自持有一把只保护查表和链表的锁，
+// 读盘始终在锁外进行，两个线程同时缺同一页时各读一次，先插入的生效，
+// 渲染线程之间不会因为缺页互相等待。
+// 每个线程另有一个小的直接映射表缓存最近用过的页，命中时不碰任何锁；
+// 页以 shared_ptr 交出，被淘汰的页在最后一个使用者放手后才释放
+class TileCache {
+public:
+  using Page = std::vector<uint32_t>;
+  using PagePtr = std::shared_ptr<const Page>;
+
+  static TileCache &instance();
+
+  // 为一张纹理分配页键的高 32 位，不会重复使用
+  uint32_t register_texture();
+
+  void set_budget(size_t bytes);
+  size_t budget() const { return budget_bytes.load(); }
+
+  // 键为 (纹理编号 << 32) | 页号，缺页时调用 load 读盘
+  PagePtr get(uint64_t key, const std::function<PagePtr()> &load);
+
+  // 打印命中率、缺页与淘汰次数以及常驻内存
+  void report() const;
+
+private:
+  static constexpr int SHARDS = 64;
+
+  struct Entry {
+    uint64_t key;
+    PagePtr page;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> lru; // 表头最近使用
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+  };
+
+  TileCache();
+
+  std::vector<Shard> shards;
+  std::atomic<size_t> budget_bytes;
+  std::atomic<uint32_t> next_texture{1};
+
+  std::atomic<uint64_t> local_hits{0};
+  std::atomic<uint64_t> shared_hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> duplicate_reads{0};
+  std::atomic<uint64_t> evictions{0};
+  std::atomic<size_t> resident{0};
+  std::atomic<size_t> peak{0};
+};
+
+} // namespace texture
+} // namespace tracer
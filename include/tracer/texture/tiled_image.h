@@ -0,0 +1,93 @@
+#pragma once
+#include "opencv2/opencv.hpp"
+#include "tracer/math/vec3.h"
+#include "tracer/utils/mapped_file.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tracer {
+namespace texture {
+
+// 分块存储的 8 位 RGBA 图像：4x4 个像素组成一块，恰好一条缓存行，
+// 块内按行排列。双线性查询的 2x2 邻域大多落在同一块内，
+// 而按行存储时总要跨越两行。加载时把 BGR 重排为 RGBA，
+// 查询时一个像素是一次 32 位读取，在 SSE 寄存器中展开成 4 个 float，
+// 四个像素的插值也在寄存器中完成。
+// 像素生成后不再修改，复制时共享同一份数据；数据也可以直接来自映射的
+// 缓存文件（见 DecodedCache）
+class TiledImage {
+public:
+  static constexpr int TILE = 4;
+
+  TiledImage() = default;
+
+  // 从 OpenCV 的 8 位 BGR 图像转换
+  explicit TiledImage(const cv::Mat &bgr);
+
+  // 使用映射文件中 offset 处的分块数据，file 在图像存活期间保持映射；
+  // 数据越界时返回空图像
+  static TiledImage mapped(std::shared_ptr<const utils::MappedFile> file,
+                           size_t offset, int w, int h);
+
+  // 2x2 盒式滤波得到下一级 MIP，奇数尺寸时重复最后一行/列
+  TiledImage downsample() const;
+
+  // 完整的 MIP 链，第 0 层为原图，最后一层为 1x1
+  static std::vector<TiledImage> mip_chain(const cv::Mat &bgr);
+
+  int width() const { return w; }
+  int height() const { return h; }
+  bool empty() const { return tiles == nullptr; }
+  size_t bytes() const { return tile_count * sizeof(Tile); }
+
+  // 分块数据的原始字节（bytes() 个），写缓存文件时使用
+  const void *data() const { return tiles; }
+
+  // 按 w x h 分块后的字节数
+  static size_t bytes(int w, int h);
+
+  // 与原先 cv::Mat 版本相同的坐标约定：u 映射到 [0, width - 1]，
+  // v 向下翻转，超出 [0, 1] 的坐标截断到边缘
+  Color bilinear(float u, float v) const;
+
+  // (x, y) 处像素的 RGBA，取值 [0, 1]，y 向下
+  void fetch(int x, int y, float rgba[4]) const;
+
+  // (x, y) 处打包的 RGBA 像素，按页写出到磁盘时使用
+  uint32_t packed(int x, int y) const { return texel(x, y); }
+
+  // 打包像素的双线性插值，texels 依次为左上、右上、左下、右下；
+  // 按需加载的纹理与本类共用
+  static Color bilerp(const uint32_t texels[4], float du, float dv);
+
+  static void unpack(uint32_t texel, float rgba[4]);
+
+private:
+  struct alignas(64) Tile {
+    uint32_t texel[TILE * TILE]; // 低位起依次为 R、G、B、A
+  };
+
+  int w = 0, h = 0;
+  int tiles_x = 0;
+  size_t tile_count = 0;
+  const Tile *tiles = nullptr;
+  // 像素的持有者：自己生成时为 storage，来自缓存文件时为 mapping
+  std::shared_ptr<std::vector<Tile>> storage;
+  std::shared_ptr<const utils::MappedFile> mapping;
+
+  TiledImage(int w, int h);
+
+  const uint32_t &texel(int x, int y) const {
+    return tiles[(y / TILE) * tiles_x + x / TILE]
+        .texel[(y % TILE) * TILE + x % TILE];
+  }
+  // 只在生成像素时使用，此时像素一定由 storage 持有
+  uint32_t &texel(int x, int y) {
+    return (*storage)[(y / TILE) * tiles_x + x / TILE]
+        .texel[(y % TILE) * TILE + x % TILE];
+  }
+};
+
+} // namespace texture
+} // namespace tracer
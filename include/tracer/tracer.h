@@ -1,15 +1,24 @@
 #pragma once
 #include "tracer/accelerator/bvh.h"
+#include "tracer/accelerator/light_bvh.h"
+#include "tracer/core/atmosphere_sky.h"
 #include "tracer/core/background.h"
 #include "tracer/core/camera.h"
 #include "tracer/core/hittable.h"
 #include "tracer/core/hittable_list.h"
 #include "tracer/core/material.h"
+#include "tracer/core/path_guide.h"
 #include "tracer/core/pdf.h"
+#include "tracer/core/photon_map.h"
+#include "tracer/core/radiance_cache.h"
 #include "tracer/core/ray.h"
 #include "tracer/geometry/box.h"
+#include "tracer/geometry/distant_light.h"
+#include "tracer/geometry/environment_light.h"
 #include "tracer/geometry/heart.h"
 #include "tracer/geometry/mesh.h"
+#include "tracer/geometry/mesh_cache.h"
+#include "tracer/geometry/mesh_light.h"
 #include "tracer/geometry/ocean.h"
 #include "tracer/geometry/sphere.h"
 #include "tracer/geometry/triangle.h"
@@ -23,10 +32,18 @@
 #include "tracer/material/sun_glow.h"
 #include "tracer/material/water.h"
 #include "tracer/math/vec3.h"
+#include "tracer/texture/decoded_cache.h"
 #include "tracer/texture/image_texture.h"
 #include "tracer/texture/solid_color.h"
+#include "tracer/texture/streamed_texture.h"
+#include "tracer/texture/texture_cache.h"
+#include "tracer/texture/tile_cache.h"
+#include "tracer/texture/tiled_image.h"
 #include "tracer/transform/rotate.h"
 #include "tracer/transform/translate.h"
+#include "tracer/utils/asset_pipeline.h"
+#include "tracer/utils/content_hash.h"
+#include "tracer/utils/mapped_file.h"
 #include "tracer/utils/timer.h"
 #include "tracer/volume/constant_medium.h"
 #include "tracer/volume/medium.h"
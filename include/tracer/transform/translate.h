@@ -18,6 +18,17 @@ public:
     return ptr->get_material();
   }
 
+  virtual float pdf_value(const Point3 &o, const Vec3 &v) const override;
+  virtual Vec3 random(const Point3 &o) const override;
+  virtual float light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const override;
+  virtual std::shared_ptr<hittable> light_source() const override;
+  virtual float emitted_power() const override {
+    return ptr->emitted_power();
+  }
+  virtual bool emission_cone(Vec3 &axis, float &cos_theta_o) const override;
+  virtual float sample_surface(hit_record &rec) const override;
+
   std::shared_ptr<hittable> ptr;
   Vec3 offset;
 };
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tracer {
+namespace utils {
+
+// 资源加载的任务调度：读文件、解码纹理、构建网格等工作作为任务提交，
+// 带依赖的任务在所依赖的任务全部完成后才进入队列，互不依赖的模型和
+// 纹理在工作线程上并行加载。
+// 等待结果一律用 wait()：在工作线程里等待时会顺带执行队列中的任务，
+// 任务里再提交子任务并等待也不会因为线程耗尽而死锁
+class AssetPipeline {
+public:
+  struct Node {
+    std::function<void()> run;
+    std::atomic<int> pending{1};
+    std::mutex mutex;
+    bool done = false;
+    std::vector<std::shared_ptr<Node>> dependents;
+  };
+
+  template <class T> struct Job {
+    std::shared_ptr<Node> node;
+    std::shared_future<T> result;
+
+    bool valid() const { return result.valid(); }
+  };
+
+  static AssetPipeline &instance();
+
+  ~AssetPipeline();
+
+  // deps 为所依赖任务的 node；任务抛出的异常在 wait() 时重新抛出
+  template <class F>
+  auto submit(F work, const std::vector<std::shared_ptr<Node>> &deps = {})
+      -> Job<std::invoke_result_t<F>> {
+    using R = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(work));
+    Job<R> job{std::make_shared<Node>(), task->get_future().share()};
+    job.node->run = [task]() { (*task)(); };
+    schedule(job.node, deps);
+    return job;
+  }
+
+  template <class T> T wait(const Job<T> &job) {
+    while (job.result.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+      if (!run_one())
+        job.result.wait_for(std::chrono::milliseconds(1));
+    }
+    return job.result.get();
+  }
+
+  int workers() const { return static_cast<int>(threads.size()); }
+
+private:
+  AssetPipeline();
+
+  void schedule(const std::shared_ptr<Node> &node,
+                const std::vector<std::shared_ptr<Node>> &deps);
+  void enqueue(std::shared_ptr<Node> node);
+  void execute(const std::shared_ptr<Node> &node);
+  bool run_one();
+  void worker();
+
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<std::shared_ptr<Node>> queue;
+  std::vector<std::thread> threads;
+  bool stopping = false;
+
+  // 任务中 OpenMP 并行区域可用的线程总数，按正在执行的任务数平分
+  int omp_threads = 1;
+  std::atomic<int> running{0};
+};
+
+} // namespace utils
+} // namespace tracer
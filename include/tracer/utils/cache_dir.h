@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+namespace tracer {
+namespace utils {
+
+// 当前用户私有的缓存目录 name：设置了 XDG_CACHE_HOME 时为其下的
+// rayt/name，否则为系统临时目录下带用户 id 后缀的 rayt_name_<uid>
+// （Windows 的临时目录本身就按用户区分）。
+// POSIX 下目录按 0700 创建；已存在的目录属主不是当前用户、是符号链接
+// 或者其他用户可写时返回空串，调用方据此关闭缓存
+std::string user_cache_dir(const std::string &name);
+
+} // namespace utils
+} // namespace tracer
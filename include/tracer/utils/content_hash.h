@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace tracer {
+namespace utils {
+
+// 字节内容的 64 位散列，用作磁盘缓存的键；大块数据分段并行计算。
+// seed 用于把多个文件或附加参数串联到同一个散列中
+uint64_t content_hash(const void *data, size_t size, uint64_t seed = 0);
+
+} // namespace utils
+} // namespace tracer
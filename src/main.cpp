@@ -1,3 +1,4 @@
+#include "tracer/accelerator/light_bvh.h"
 #include "tracer/parser/factory.h"
 #include "tracer/utils/timer.h"
 
@@ -22,15 +23,16 @@ int main(int argc, char *argv[]) {
     hittable_list world = factory.take_world();
 
     BVH bvh_world = BVH(world);
+    LightBVH light_bvh = LightBVH(lights);
 
     {
       utils::RenderTimer timer("渲染");
 
       if (argc <= 2) {
-        cam.render(bvh_world, lights, false);
+        cam.render(bvh_world, light_bvh, false);
       } else if (std::string(argv[2]) == "--heatmap") {
         std::cout << "当前渲染效果为热力图模式" << std::endl;
-        cam.render(bvh_world, lights, true);
+        cam.render(bvh_world, light_bvh, true);
       }
     }
   } catch (const parser::ParseException &e) {
@@ -0,0 +1,321 @@
+#include "tracer/accelerator/light_bvh.h"
+
+namespace tracer {
+
+float LightBounds::importance(const Point3 &p) const {
+  if (power <= 0.0f)
+    return 0.0f;
+
+  Point3 pc = bounds.centroid();
+  float radius2 = 0.25f * (bounds.max - bounds.min).squared_length();
+  float dist2 = (p - pc).squared_length();
+  // 距离至少取包围球半径，避免在光源附近或内部时重要性发散
+  float d2 = std::max(dist2, radius2);
+  if (cos_theta_o <= -1.0f || dist2 <= radius2)
+    return power / d2;
+
+  // 方向锥轴与 pc->p 的夹角，减去锥半角和包围球对 p 的张角后
+  // 得到 p 方向上最小可能的出射角
+  Vec3 wi = (p - pc) / std::sqrt(dist2);
+  float theta_w = std::acos(std::clamp(dot(axis, wi), -1.0f, 1.0f));
+  float theta_o = std::acos(std::clamp(cos_theta_o, -1.0f, 1.0f));
+  float theta_b = std::asin(std::sqrt(std::min(radius2 / dist2, 1.0f)));
+  float theta = theta_w - theta_o - theta_b;
+  if (theta >= 0.5f * math::TRACER_PI)
+    return 0.0f;
+  float cos_theta = theta > 0.0f ? std::cos(theta) : 1.0f;
+  return power * cos_theta / d2;
+}
+
+LightBounds LightBounds::merge(const LightBounds &a, const LightBounds &b) {
+  LightBounds lb;
+  lb.bounds = AABB::surrounding_box(a.bounds, b.bounds);
+  lb.power = a.power + b.power;
+  if (a.cos_theta_o <= -1.0f || b.cos_theta_o <= -1.0f)
+    return lb;
+
+  // 两个方向锥的最小外接锥
+  float theta_a = std::acos(std::clamp(a.cos_theta_o, -1.0f, 1.0f));
+  float theta_b = std::acos(std::clamp(b.cos_theta_o, -1.0f, 1.0f));
+  float theta_d = std::acos(std::clamp(dot(a.axis, b.axis), -1.0f, 1.0f));
+  if (std::min(theta_d + theta_b, math::TRACER_PI) <= theta_a) {
+    lb.axis = a.axis;
+    lb.cos_theta_o = a.cos_theta_o;
+    return lb;
+  }
+  if (std::min(theta_d + theta_a, math::TRACER_PI) <= theta_b) {
+    lb.axis = b.axis;
+    lb.cos_theta_o = b.cos_theta_o;
+    return lb;
+  }
+
+  float theta_o = 0.5f * (theta_a + theta_d + theta_b);
+  Vec3 k = cross(a.axis, b.axis);
+  if (theta_o >= math::TRACER_PI || k.squared_length() < 1e-12f)
+    return lb;
+
+  // 把 a.axis 绕 k 向 b.axis 旋转 theta_o - theta_a（k 与 a.axis 垂直）
+  k = normalize(k);
+  float theta_r = theta_o - theta_a;
+  lb.axis = normalize(a.axis * std::cos(theta_r) +
+                      cross(k, a.axis) * std::sin(theta_r));
+  lb.cos_theta_o = std::cos(theta_o);
+  return lb;
+}
+
+LightBVH::LightBVH(const hittable_list &list, LightSampling mode)
+    : mode(mode) {
+  std::vector<LightBounds> lbs;
+  std::vector<float> powers;
+  for (const auto &light : list.objects) {
+    LightBounds lb;
+    if (!light->bounding_box(0.0f, 0.0f, lb.bounds)) {
+      infinite.push_back(light);
+      continue;
+    }
+    // 包围盒外扩一点，避免平面光源的扁平包围盒被 AABB::hit 漏掉
+    Vec3 pad = 1e-4f * (lb.bounds.max - lb.bounds.min) +
+               Vec3(1e-4f, 1e-4f, 1e-4f);
+    lb.bounds = AABB(lb.bounds.min - pad, lb.bounds.max + pad);
+    lb.power = light->emitted_power();
+    light->emission_cone(lb.axis, lb.cos_theta_o);
+    lights.push_back(light);
+    lbs.push_back(lb);
+    powers.push_back(lb.power);
+  }
+
+  if (lights.empty())
+    return;
+
+  // 功率估计为 0 的光源仍需保留被选中的机会，否则其贡献只能靠 BSDF 采样
+  float max_power = *std::max_element(powers.begin(), powers.end());
+  float min_power = max_power > 0.0f ? 1e-3f * max_power : 1.0f;
+  for (size_t i = 0; i < lbs.size(); ++i) {
+    lbs[i].power = std::max(lbs[i].power, min_power);
+    powers[i] = lbs[i].power;
+  }
+  power_table = math::AliasTable(powers);
+
+  std::vector<uint32_t> ids(lights.size());
+  for (uint32_t i = 0; i < ids.size(); ++i)
+    ids[i] = i;
+  nodes.reserve(2 * lights.size() - 1);
+  build(ids, lbs, 0, ids.size());
+}
+
+uint32_t LightBVH::build(std::vector<uint32_t> &ids,
+                         const std::vector<LightBounds> &lbs, size_t start,
+                         size_t end) {
+  uint32_t idx = static_cast<uint32_t>(nodes.size());
+  nodes.emplace_back();
+
+  if (end - start == 1) {
+    nodes[idx].lb = lbs[ids[start]];
+    nodes[idx].light = static_cast<int32_t>(ids[start]);
+    return idx;
+  }
+
+  AABB centroid_box(lbs[ids[start]].bounds.centroid(),
+                    lbs[ids[start]].bounds.centroid());
+  for (size_t i = start + 1; i < end; ++i)
+    centroid_box.expand(lbs[ids[i]].bounds.centroid());
+  int axis = centroid_box.max_extent();
+
+  size_t mid = start + (end - start) / 2;
+  std::nth_element(ids.begin() + start, ids.begin() + mid, ids.begin() + end,
+                   [&](uint32_t a, uint32_t b) {
+                     return lbs[a].bounds.centroid()[axis] <
+                            lbs[b].bounds.centroid()[axis];
+                   });
+
+  uint32_t left = build(ids, lbs, start, mid);
+  uint32_t right = build(ids, lbs, mid, end);
+  nodes[idx].left = left;
+  nodes[idx].right = right;
+  nodes[idx].lb = LightBounds::merge(nodes[left].lb, nodes[right].lb);
+  return idx;
+}
+
+float LightBVH::tree_prob() const {
+  if (nodes.empty())
+    return 0.0f;
+  return 1.0f / static_cast<float>(infinite.size() + 1);
+}
+
+float LightBVH::left_prob(const Node &node, const Point3 &o) const {
+  float il = nodes[node.left].lb.importance(o);
+  float ir = nodes[node.right].lb.importance(o);
+  if (il + ir <= 0.0f)
+    return 0.5f;
+  return il / (il + ir);
+}
+
+bool LightBVH::hit(const Ray &r, float t_min, float t_max,
+                   hit_record &rec) const {
+  bool hit_anything = false;
+  for (const auto &light : infinite) {
+    if (light->hit(r, t_min, t_max, rec)) {
+      hit_anything = true;
+      t_max = rec.t;
+    }
+  }
+  if (nodes.empty())
+    return hit_anything;
+
+  uint32_t stack[64];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0) {
+    const Node &node = nodes[stack[--sp]];
+    if (!node.lb.bounds.hit(r, t_min, t_max))
+      continue;
+    if (node.light >= 0) {
+      if (lights[node.light]->hit(r, t_min, t_max, rec)) {
+        hit_anything = true;
+        t_max = rec.t;
+      }
+    } else {
+      stack[sp++] = node.left;
+      stack[sp++] = node.right;
+    }
+  }
+  return hit_anything;
+}
+
+bool LightBVH::bounding_box(float t0, float t1, AABB &output_box) const {
+  if (nodes.empty() || !infinite.empty())
+    return false;
+  output_box = nodes[0].lb.bounds;
+  return true;
+}
+
+float LightBVH::select_prob(const Node &leaf, float prob) const {
+  // 别名表的选择概率与位置无关，到叶子处再乘上该光源的 pmf
+  if (mode == LightSampling::Power)
+    return prob * power_table.pmf(leaf.light);
+  return prob;
+}
+
+void LightBVH::pdf_recursive(uint32_t idx, const Ray &r, float prob,
+                             float &sum) const {
+  const Node &node = nodes[idx];
+  if (prob <= 0.0f || !node.lb.bounds.hit(r, 0.001f, math::INF))
+    return;
+
+  if (node.light >= 0) {
+    sum += select_prob(node, prob) *
+           lights[node.light]->pdf_value(r.origin(), r.direction());
+    return;
+  }
+
+  if (mode == LightSampling::Power) {
+    pdf_recursive(node.left, r, prob, sum);
+    pdf_recursive(node.right, r, prob, sum);
+  } else {
+    float pl = left_prob(node, r.origin());
+    pdf_recursive(node.left, r, prob * pl, sum);
+    pdf_recursive(node.right, r, prob * (1.0f - pl), sum);
+  }
+}
+
+float LightBVH::pdf_value(const Point3 &o, const Vec3 &v) const {
+  float sum = 0.0f;
+  if (!infinite.empty()) {
+    float weight = 1.0f / static_cast<float>(infinite.size() +
+                                             (nodes.empty() ? 0 : 1));
+    for (const auto &light : infinite)
+      sum += weight * light->pdf_value(o, v);
+  }
+
+  if (nodes.empty())
+    return sum;
+
+  Ray r(o, v);
+  pdf_recursive(0, r, tree_prob(), sum);
+  return sum;
+}
+
+void LightBVH::light_pdf_recursive(uint32_t idx, const Point3 &o,
+                                   const Vec3 &v, const hit_record &rec,
+                                   float prob, float &sum) const {
+  const Node &node = nodes[idx];
+  const AABB &b = node.lb.bounds;
+  if (prob <= 0.0f || rec.p.x() < b.min.x() || rec.p.y() < b.min.y() ||
+      rec.p.z() < b.min.z() || rec.p.x() > b.max.x() ||
+      rec.p.y() > b.max.y() || rec.p.z() > b.max.z())
+    return;
+
+  if (node.light >= 0) {
+    sum += select_prob(node, prob) * lights[node.light]->light_pdf(o, v, rec);
+    return;
+  }
+
+  if (mode == LightSampling::Power) {
+    light_pdf_recursive(node.left, o, v, rec, prob, sum);
+    light_pdf_recursive(node.right, o, v, rec, prob, sum);
+  } else {
+    float pl = left_prob(node, o);
+    light_pdf_recursive(node.left, o, v, rec, prob * pl, sum);
+    light_pdf_recursive(node.right, o, v, rec, prob * (1.0f - pl), sum);
+  }
+}
+
+float LightBVH::light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const {
+  float sum = 0.0f;
+  if (!infinite.empty()) {
+    float weight = 1.0f / static_cast<float>(infinite.size() +
+                                             (nodes.empty() ? 0 : 1));
+    for (const auto &light : infinite)
+      sum += weight * light->light_pdf(o, v, rec);
+  }
+
+  if (!nodes.empty())
+    light_pdf_recursive(0, o, v, rec, tree_prob(), sum);
+  return sum;
+}
+
+Vec3 LightBVH::random(const Vec3 &o) const {
+  if (size() == 0)
+    return Vec3(0.0f, 0.0f, 0.0f);
+
+  if (!infinite.empty()) {
+    int strata = static_cast<int>(infinite.size()) + (nodes.empty() ? 0 : 1);
+    int k = math::random_int(0, strata - 1);
+    if (k < static_cast<int>(infinite.size()))
+      return infinite[k]->random(o);
+  }
+
+  if (mode == LightSampling::Power)
+    return lights[power_table.sample(math::random_float())]->random(o);
+
+  uint32_t idx = 0;
+  while (nodes[idx].light < 0) {
+    const Node &node = nodes[idx];
+    idx = math::random_float() < left_prob(node, o) ? node.left : node.right;
+  }
+  return lights[nodes[idx].light]->random(o);
+}
+
+bool LightBVH::emit_photon(const AABB &scene, Ray &ray,
+                           Color &flux) const {
+  if (size() == 0)
+    return false;
+
+  int strata = static_cast<int>(infinite.size()) + (nodes.empty() ? 0 : 1);
+  int k = math::random_int(0, strata - 1);
+  if (k < static_cast<int>(infinite.size())) {
+    if (!infinite[k]->emit_photon(scene, ray, flux))
+      return false;
+    flux *= static_cast<float>(strata);
+    return true;
+  }
+
+  uint32_t i = power_table.sample(math::random_float());
+  if (!lights[i]->emit_photon(scene, ray, flux))
+    return false;
+  flux *= static_cast<float>(strata) / power_table.pmf(i);
+  return true;
+}
+
+} // namespace tracer
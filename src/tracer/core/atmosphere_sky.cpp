@@ -0,0 +1,214 @@
+#include "tracer/core/atmosphere_sky.h"
+#include "tracer/geometry/distant_light.h"
+
+namespace tracer {
+
+// 地球与大气层半径（米），观察者位于海平面以上 1 米
+static constexpr float EARTH_RADIUS = 6360e3f;
+static constexpr float ATMOSPHERE_RADIUS = 6420e3f;
+static constexpr float VIEWER_HEIGHT = 1.0f;
+
+// 瑞利散射与米氏散射的标高和海平面散射系数
+static constexpr float RAYLEIGH_HEIGHT = 7994.0f;
+static constexpr float MIE_HEIGHT = 1200.0f;
+static const Vec3 BETA_RAYLEIGH(5.8e-6f, 13.5e-6f, 33.1e-6f);
+static constexpr float BETA_MIE = 21e-6f;
+static constexpr float MIE_EXTINCTION = 1.1f; // 米氏消光 / 散射
+static constexpr float MIE_G = 0.76f;
+
+// 视线和太阳方向上的步进次数
+static constexpr int VIEW_SAMPLES = 64;
+static constexpr int LIGHT_SAMPLES = 16;
+
+// 地球尺度下 |o|² - r² 在 float 中会严重抵消，以下求交用 double 计算
+static double dot_d(const Vec3 &a, const Vec3 &b) {
+  return static_cast<double>(a.x()) * b.x() +
+         static_cast<double>(a.y()) * b.y() +
+         static_cast<double>(a.z()) * b.z();
+}
+
+// 射线 (o, d) 与以原点为球心的球面的交点，返回较远的一个，没有时返回 -1
+static float ray_sphere_far(const Vec3 &o, const Vec3 &d, double radius) {
+  double b = dot_d(o, d);
+  double c = dot_d(o, o) - radius * radius;
+  double disc = b * b - c;
+  if (disc < 0.0)
+    return -1.0f;
+  return static_cast<float>(-b + std::sqrt(disc));
+}
+
+// 从大气中一点出发的射线是否撞上地面
+static bool hits_ground(const Vec3 &o, const Vec3 &d) {
+  double b = dot_d(o, d);
+  if (b > 0.0)
+    return false;
+  double r = EARTH_RADIUS;
+  double c = dot_d(o, o) - r * r;
+  return b * b - c > 0.0;
+}
+
+static Color extinction(float optical_rayleigh, float optical_mie) {
+  Vec3 tau = BETA_RAYLEIGH * optical_rayleigh +
+             Vec3(1.0f, 1.0f, 1.0f) * (BETA_MIE * MIE_EXTINCTION *
+                                        optical_mie);
+  return Color(std::exp(-tau.x()), std::exp(-tau.y()), std::exp(-tau.z()));
+}
+
+AtmosphereSky::AtmosphereSky(const Vec3 &sun_direction, const Vec3 &up,
+                             float intensity)
+    : sun_dir(unit_vector(sun_direction)), up(unit_vector(up)),
+      intensity(intensity) {
+  build_frame();
+  build_lut();
+}
+
+void AtmosphereSky::build_frame() {
+  sun_forward = sun_dir - dot(sun_dir, up) * up;
+  if (sun_forward.squared_length() < 1e-8f) {
+    // 太阳在天顶时方位角没有意义，任取一个水平方向
+    Vec3 a = std::fabs(up.x()) > 0.9f ? Vec3(0, 1, 0) : Vec3(1, 0, 0);
+    sun_forward = cross(up, a);
+  }
+  sun_forward = unit_vector(sun_forward);
+  sun_side = cross(up, sun_forward);
+}
+
+Color AtmosphereSky::transmittance(const Vec3 &p, const Vec3 &dir) const {
+  if (hits_ground(p, dir))
+    return Color(0.0f, 0.0f, 0.0f);
+
+  float t_max = ray_sphere_far(p, dir, ATMOSPHERE_RADIUS);
+  float ds = t_max / LIGHT_SAMPLES;
+  float optical_r = 0.0f, optical_m = 0.0f;
+  for (int i = 0; i < LIGHT_SAMPLES; ++i) {
+    Vec3 q = p + (i + 0.5f) * ds * dir;
+    float h = q.length() - EARTH_RADIUS;
+    optical_r += std::exp(-h / RAYLEIGH_HEIGHT) * ds;
+    optical_m += std::exp(-h / MIE_HEIGHT) * ds;
+  }
+  return extinction(optical_r, optical_m);
+}
+
+Color AtmosphereSky::integrate(const Vec3 &dir) const {
+  // 局部坐标：z 为天顶，太阳位于 x-z 平面
+  Vec3 o(0.0f, 0.0f, EARTH_RADIUS + VIEWER_HEIGHT);
+  Vec3 sun(dot(sun_dir, sun_forward), 0.0f, dot(sun_dir, up));
+  float t_max = ray_sphere_far(o, dir, ATMOSPHERE_RADIUS);
+
+  float mu = dot(dir, sun);
+  float phase_r = 3.0f / (16.0f * math::TRACER_PI) * (1.0f + mu * mu);
+  float g2 = MIE_G * MIE_G;
+  float phase_m = 3.0f / (8.0f * math::TRACER_PI) * (1.0f - g2) *
+                  (1.0f + mu * mu) /
+                  ((2.0f + g2) *
+                   std::pow(1.0f + g2 - 2.0f * MIE_G * mu, 1.5f));
+
+  // 靠近观察者处密度最大，按 t = t_max * s² 分段，使步长由近及远增大
+  Color sum_r(0.0f, 0.0f, 0.0f), sum_m(0.0f, 0.0f, 0.0f);
+  float optical_r = 0.0f, optical_m = 0.0f;
+  for (int i = 0; i < VIEW_SAMPLES; ++i) {
+    float s0 = static_cast<float>(i) / VIEW_SAMPLES;
+    float s1 = static_cast<float>(i + 1) / VIEW_SAMPLES;
+    float ds = t_max * (s1 * s1 - s0 * s0);
+    float t = t_max * 0.5f * (s0 * s0 + s1 * s1);
+    Vec3 p = o + t * dir;
+    float h = p.length() - EARTH_RADIUS;
+    float hr = std::exp(-h / RAYLEIGH_HEIGHT) * ds;
+    float hm = std::exp(-h / MIE_HEIGHT) * ds;
+    optical_r += hr;
+    optical_m += hm;
+
+    Color t_sun = transmittance(p, sun);
+    Color t_view = extinction(optical_r, optical_m);
+    sum_r += hr * t_view * t_sun;
+    sum_m += hm * t_view * t_sun;
+  }
+
+  return intensity * (sum_r * BETA_RAYLEIGH * phase_r +
+                      sum_m * BETA_MIE * phase_m);
+}
+
+void AtmosphereSky::build_lut() {
+  lut.assign((ZENITH_RES + 1) * (AZIMUTH_RES + 1), Color(0, 0, 0));
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int j = 0; j <= ZENITH_RES; ++j) {
+    float theta = 0.5f * math::TRACER_PI * j / ZENITH_RES;
+    // 地平线上沿水平方向看出去的路径最长，稍微抬高避免擦到地面
+    theta = std::min(theta, 0.5f * math::TRACER_PI - 1e-4f);
+    for (int k = 0; k <= AZIMUTH_RES; ++k) {
+      float phi = math::TRACER_PI * k / AZIMUTH_RES;
+      Vec3 dir(std::sin(theta) * std::cos(phi),
+               std::sin(theta) * std::sin(phi), std::cos(theta));
+      lut[j * (AZIMUTH_RES + 1) + k] = integrate(dir);
+    }
+  }
+}
+
+void AtmosphereSky::add_sun(std::shared_ptr<const geometry::DistantLight> sun) {
+  if (suns.empty()) {
+    Vec3 d = sun->direction();
+    if ((d - sun_dir).squared_length() > 1e-10f) {
+      sun_dir = d;
+      build_frame();
+      build_lut();
+    }
+  }
+  Background::add_sun(std::move(sun));
+}
+
+void AtmosphereSky::direction_to_uv(const Vec3 &dir, float &u,
+                                    float &v) const {
+  Vec3 d = unit_vector(dir);
+  float theta = std::acos(std::clamp(dot(d, up), -1.0f, 1.0f));
+  float phi = std::atan2(dot(d, sun_side), dot(d, sun_forward));
+  u = (phi + math::TRACER_PI) / (2.0f * math::TRACER_PI);
+  v = theta / math::TRACER_PI;
+}
+
+Vec3 AtmosphereSky::uv_to_direction(float u, float v) const {
+  float phi = 2.0f * math::TRACER_PI * u - math::TRACER_PI;
+  float theta = math::TRACER_PI * v;
+  float sin_theta = std::sin(theta);
+  return unit_vector(sin_theta * std::cos(phi) * sun_forward +
+                     sin_theta * std::sin(phi) * sun_side +
+                     std::cos(theta) * up);
+}
+
+float AtmosphereSky::luminance(int x, int y) const {
+  // 经纬度格点 -> 查找表格点：方位角关于太阳对称，地平线以下取地平线
+  int k = std::abs(std::clamp(x, 0, 2 * AZIMUTH_RES) - AZIMUTH_RES);
+  int j = std::min(std::clamp(y, 0, 2 * ZENITH_RES), ZENITH_RES);
+  const Color &c = lut_at(j, k);
+  return 0.2126f * c.r() + 0.7152f * c.g() + 0.0722f * c.b();
+}
+
+Color AtmosphereSky::value(const Ray &r) const {
+  float u, v;
+  direction_to_uv(r.direction(), u, v);
+
+  // 经纬度坐标与查找表格点一一对应，插值结果与 luminance 的网格一致
+  float xf = u * 2.0f * AZIMUTH_RES;
+  float yf = std::min(v * 2.0f * ZENITH_RES, static_cast<float>(ZENITH_RES));
+  int x = std::min(static_cast<int>(xf), 2 * AZIMUTH_RES - 1);
+  int y = std::min(static_cast<int>(yf), ZENITH_RES - 1);
+  float dx = xf - x;
+  float dy = yf - y;
+
+  auto at = [&](int xi, int yi) -> const Color & {
+    return lut_at(yi, std::abs(xi - AZIMUTH_RES));
+  };
+  return (1 - dx) * (1 - dy) * at(x, y) + dx * (1 - dy) * at(x + 1, y) +
+         (1 - dx) * dy * at(x, y + 1) + dx * dy * at(x + 1, y + 1);
+}
+
+Color AtmosphereSky::sun_radiance(float angular_radius) const {
+  Vec3 o(0.0f, 0.0f, EARTH_RADIUS + VIEWER_HEIGHT);
+  Vec3 sun(dot(sun_dir, sun_forward), 0.0f, dot(sun_dir, up));
+  float theta = std::clamp(angular_radius, 0.01f, 90.0f) *
+                tracer::math::TRACER_PI / 180.f;
+  float s = std::sin(0.5f * theta);
+  float solid_angle = 2.0f * math::TRACER_PI * 2.0f * s * s;
+  return intensity * transmittance(o, sun) / solid_angle;
+}
+
+} // namespace tracer
@@ -1,7 +1,20 @@
 #include "tracer/core/background.h"
+#include "tracer/geometry/distant_light.h"
+#include "tracer/texture/decoded_cache.h"
 
 namespace tracer {
 
+void Background::add_sun(std::shared_ptr<const geometry::DistantLight> sun) {
+  suns.push_back(std::move(sun));
+}
+
+Color Background::radiance(const Ray &r) const {
+  Color c = value(r);
+  for (const auto &sun : suns)
+    c += sun->Le(r.direction());
+  return c;
+}
+
 PhysicalSky::PhysicalSky(const Vec3 &sun_direction)
     : sun_dir(unit_vector(sun_direction)), sky_bottom(1.0f, 1.0f, 1.0f),
       sky_top(0.2f, 0.4f, 0.8f) {}
@@ -22,17 +35,26 @@ Color PhysicalSky::value(const Ray &r) const {
     float glare_factor = std::pow(cos_theta, 500.0f);
     float bloom_factor = std::pow(cos_theta, 10.0f); // 大范围微弱光晕
 
-    sun_glare = Color(5.0f, 4.0f, 2.0f) * glare_factor +
-                Color(0.5f, 0.3f, 0.1f) * bloom_factor;
+    sun_glare = Color(0.5f, 0.3f, 0.1f) * bloom_factor;
+    if (!analytic_sun)
+      sun_glare += Color(5.0f, 4.0f, 2.0f) * glare_factor;
   }
 
   return base_sky + sun_glare;
 }
 
+void PhysicalSky::add_sun(std::shared_ptr<const geometry::DistantLight> sun) {
+  if (suns.empty()) {
+    sun_dir = sun->direction();
+    analytic_sun = true;
+  }
+  Background::add_sun(std::move(sun));
+}
+
 ImageBackground::ImageBackground(const std::string &filepath,
                                  const Vec3 &forward, const Vec3 &vup)
     : forward(forward), vup(vup) {
-  img = cv::imread(filepath, cv::IMREAD_ANYDEPTH | cv::IMREAD_COLOR);
+  img = texture::DecodedCache::instance().image(filepath, mapping);
   if (img.empty()) {
     std::cerr << "无法加载背景图片: " << filepath << "，切换至纯黑背景。"
               << std::endl;
@@ -50,20 +72,59 @@ ImageBackground::ImageBackground(const std::string &filepath,
   up = cross(right, forward);
 }
 
-Color ImageBackground::value(const Ray &r_in) const {
-  if (img.empty())
-    return Color(0, 0, 0);
+// 贴图水平方向相对 phi 的偏移
+static constexpr float ROTATION_OFFSET = 0.5f;
 
-  Vec3 d = unit_vector(r_in.direction());
+void ImageBackground::direction_to_uv(const Vec3 &dir, float &u,
+                                      float &v) const {
+  Vec3 d = unit_vector(dir);
 
   Vec3 local_d = Vec3(dot(d, right), dot(d, forward), dot(d, up));
   float phi = std::atan2(-local_d.y(), local_d.x());
   float theta = std::acos(std::clamp(local_d.z(), -1.0f, 1.0f));
 
-  float rotation_offset = 0.5f;
-  float u = (phi + math::TRACER_PI) / (2.0f * math::TRACER_PI);
-  float v = theta / math::TRACER_PI;
-  u = fmod(u + rotation_offset, 1.0f);
+  u = (phi + math::TRACER_PI) / (2.0f * math::TRACER_PI);
+  v = theta / math::TRACER_PI;
+  u = fmod(u + ROTATION_OFFSET, 1.0f);
+}
+
+Vec3 ImageBackground::uv_to_direction(float u, float v) const {
+  u -= ROTATION_OFFSET;
+  if (u < 0.0f)
+    u += 1.0f;
+  float phi = 2.0f * math::TRACER_PI * u - math::TRACER_PI;
+  float theta = math::TRACER_PI * v;
+  float sin_theta = std::sin(theta);
+
+  Vec3 local_d(sin_theta * std::cos(phi), -sin_theta * std::sin(phi),
+               std::cos(theta));
+  return unit_vector(local_d.x() * right + local_d.y() * forward +
+                     local_d.z() * up);
+}
+
+Color ImageBackground::texel(int x, int y) const {
+  x = std::clamp(x, 0, width);
+  y = std::clamp(y, 0, height);
+  if (img.depth() == CV_32F) {
+    cv::Vec3f bgr = img.at<cv::Vec3f>(y, x);
+    return Color(bgr[2], bgr[1], bgr[0]);
+  } else {
+    cv::Vec3b bgr = img.at<cv::Vec3b>(y, x);
+    return Color(bgr[2] / 255.0f, bgr[1] / 255.0f, bgr[0] / 255.0f);
+  }
+}
+
+float ImageBackground::luminance(int x, int y) const {
+  Color c = texel(x, y);
+  return 0.2126f * c.r() + 0.7152f * c.g() + 0.0722f * c.b();
+}
+
+Color ImageBackground::value(const Ray &r_in) const {
+  if (img.empty())
+    return Color(0, 0, 0);
+
+  float u, v;
+  direction_to_uv(r_in.direction(), u, v);
 
   float uf = u * width;
   float vf = v * height;
@@ -72,22 +133,10 @@ Color ImageBackground::value(const Ray &r_in) const {
   float du = uf - i;
   float dv = vf - j;
 
-  auto get_pixel = [&](int x, int y) {
-    x = std::clamp(x, 0, width);
-    y = std::clamp(y, 0, height);
-    if (img.depth() == CV_32F) {
-      cv::Vec3f bgr = img.at<cv::Vec3f>(y, x);
-      return Color(bgr[2], bgr[1], bgr[0]);
-    } else {
-      cv::Vec3b bgr = img.at<cv::Vec3b>(y, x);
-      return Color(bgr[2] / 255.0f, bgr[1] / 255.0f, bgr[0] / 255.0f);
-    }
-  };
-
-  Color c00 = get_pixel(i, j);
-  Color c10 = get_pixel(i + 1, j);
-  Color c01 = get_pixel(i, j + 1);
-  Color c11 = get_pixel(i + 1, j + 1);
+  Color c00 = texel(i, j);
+  Color c10 = texel(i + 1, j);
+  Color c01 = texel(i, j + 1);
+  Color c11 = texel(i + 1, j + 1);
 
   Color lerp_color = (1 - du) * (1 - dv) * c00 + du * (1 - dv) * c10 +
                      (1 - du) * dv * c01 + du * dv * c11;
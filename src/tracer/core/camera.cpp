@@ -52,41 +52,148 @@ Camera::Camera(int image_width, int image_height, int samples_per_pixel,
 const Point3 Camera::get_origin() const { return origin; }
 
 Ray Camera::get_ray(float u, float v) const {
-  return Ray(origin,
-             lower_left_corner + u * horizontal + v * vertical - origin);
+  Ray r(origin, lower_left_corner + u * horizontal + v * vertical - origin);
+  // 视平面在距离 1 处，一个像素的高度就是光锥的张角
+  r.cone_spread = vertical.length() / static_cast<float>(image_height);
+  return r;
 }
 
+// 光锥在命中点处的宽度换算到 UV 空间；掠射时按 1 / cos 拉长，
+// 截断在 8 倍以内，避免贴地的表面整片糊掉
+static float cone_footprint(const Ray &r, const hit_record &rec,
+                            float width) {
+  if (!(rec.uv_density > 0.0f))
+    return 0.0f;
+  float cos_theta = std::fabs(dot(unit_vector(r.direction()), rec.normal));
+  return rec.uv_density * width / std::max(cos_theta, 0.125f);
+}
+
+// 渐进式光子映射的半径收缩系数：r_{i+1}^2 = r_i^2 * (i + alpha) / (i + 1)
+static constexpr float PPM_ALPHA = 2.0f / 3.0f;
+static constexpr int PPM_MAX_PASSES = 16;
+
+// 沿用上一帧的辐亮度缓存时旧统计保留的比例
+static constexpr float RADIANCE_CACHE_KEEP = 0.5f;
+static constexpr float RADIANCE_CACHE_RESOLUTION = 64.0f;
+
 void Camera::render(const hittable &world, const hittable &lights,
                     bool visual_bvh = false) {
   cv::Mat img = cv::Mat::zeros(cv::Size(image_width, image_height), CV_8UC3);
 
-  auto start = std::chrono::steady_clock::now();
-  int completed_rows = 0;
+  // 辐亮度缓存以世界坐标为键，场景在帧间移动时不会错位，
+  // 旧统计按比例衰减后逐渐被新样本覆盖
+  if (radiance_cache_depth <= 0 || visual_bvh) {
+    radiance_cache.reset();
+  } else if (keep_radiance_cache && radiance_cache) {
+    radiance_cache->decay(RADIANCE_CACHE_KEEP);
+  } else {
+    float cell = radiance_cache_cell;
+    AABB bounds;
+    if (!(cell > 0.0f) && world.bounding_box(0.0f, 1.0f, bounds))
+      cell = (bounds.max - bounds.min).length() / RADIANCE_CACHE_RESOLUTION;
+    if (cell > 0.0f) {
+      radiance_cache = std::make_shared<RadianceCache>(cell);
+    } else {
+      radiance_cache.reset();
+      std::cerr << "辐亮度缓存: 场景没有包围盒，不启用。" << std::endl;
+    }
+  }
 
-#pragma omp parallel for schedule(dynamic, 1)
-  for (int j = image_height - 1; j >= 0; --j) {
-    for (int i = 0; i < image_width; ++i) {
-      Color pixel(0.f, 0.f, 0.f);
-      for (int s = 0; s < samples_per_pixel; ++s) {
-        float u = (i + tracer::math::random_float()) / (image_width - 1),
-              v = (j + tracer::math::random_float()) / (image_height - 1);
+  guide.reset();
+  if (guiding_passes > 0 && !visual_bvh)
+    train_guide(world, lights);
+
+  // 焦散光子图：样本分到若干轮中，每轮重新发射光子，
+  // 光子图的内存只与每轮的光子数有关
+  photons.reset();
+  AABB scene;
+  int passes = 1;
+  if (caustic_photons > 0 && !visual_bvh) {
+    if (world.bounding_box(0.0f, 1.0f, scene)) {
+      photons = std::make_shared<PhotonMap>();
+      passes = std::clamp(samples_per_pixel, 1, PPM_MAX_PASSES);
+    } else {
+      std::cerr << "焦散光子图: 场景没有包围盒，不启用。" << std::endl;
+    }
+  }
+  float radius = caustic_radius;
 
-        hit_record rec;
+  std::vector<Color> accum(static_cast<size_t>(image_width) * image_height,
+                           Color(0.0f, 0.0f, 0.0f));
 
-        Ray r = get_ray(u, v);
+  auto start = std::chrono::steady_clock::now();
+  int completed_rows = 0;
+  long long total_bytes = 0;
+
+  for (int pass = 0; pass < passes; ++pass) {
+    const int pass_spp = samples_per_pixel / passes +
+                         (pass < samples_per_pixel % passes ? 1 : 0);
+    if (photons) {
+      photons->build(world, lights, scene, caustic_photons, max_depth, radius);
+      radius = photons->radius() *
+               std::sqrt((pass + 1 + PPM_ALPHA) / (pass + 2));
+    }
 
-        r.bvh_hit_count = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : total_bytes)
+    for (int j = image_height - 1; j >= 0; --j) {
+      for (int i = 0; i < image_width; ++i) {
+        Color pixel(0.f, 0.f, 0.f);
+        for (int s = 0; s < pass_spp; ++s) {
+          float u = (i + tracer::math::random_float()) / (image_width - 1),
+                v = (j + tracer::math::random_float()) / (image_height - 1);
+
+          hit_record rec;
+          Ray r = get_ray(u, v);
+
+          r.bvh_hit_count = 0;
+          r.bytes_touched = 0;
+
+          if (visual_bvh) {
+            world.hit(r, 0.001f, std::numeric_limits<float>::infinity(), rec);
+            total_bytes += r.bytes_touched;
+
+            float heat = static_cast<float>(r.bvh_hit_count) / 50.0f;
+            pixel += Color(heat, 0.0f, 0.0f); // R 红色通道代表热力
+          } else {
+            pixel += ray_color(r, background, world, lights, max_depth);
+          }
+        }
+        accum[static_cast<size_t>(j) * image_width + i] += pixel;
+      }
 
-        if (visual_bvh) {
-          world.hit(r, 0.001f, std::numeric_limits<float>::infinity(), rec);
+      int local_completed;
+#pragma omp atomic capture
+      {
+        completed_rows++;
+        local_completed = completed_rows;
+      }
 
-          float heat = static_cast<float>(r.bvh_hit_count) / 50.0f;
-          pixel += Color(heat, 0.0f, 0.0f); // R 红色通道代表热力
-        } else {
-          pixel += ray_color(r, background, world, lights, max_depth);
+      const int total_rows = image_height * passes;
+      if (local_completed % 2 == 0 || local_completed == total_rows) {
+#pragma omp critical
+        {
+          auto now = std::chrono::steady_clock::now();
+          std::chrono::duration<float> elapsed = now - start;
+          float progress = (float)local_completed / total_rows;
+          float remaining = (elapsed.count() / progress) - elapsed.count();
+          printf("\r渲染进度: %.2f%% | 已用时间: %.1fs | 预计剩余: %.1fs  ",
+                 progress * 100, elapsed.count(),
+                 remaining > 0.0f ? remaining : 0.0f);
         }
       }
-      pixel /= static_cast<float>(samples_per_pixel);
+    }
+  }
+  printf("\n");
+  if (photons) {
+    printf("焦散光子图: %d 轮 | 最后一轮 %zu 个光子\n", passes,
+           photons->size());
+  }
+
+#pragma omp parallel for
+  for (int j = 0; j < image_height; ++j) {
+    for (int i = 0; i < image_width; ++i) {
+      Color pixel = accum[static_cast<size_t>(j) * image_width + i] /
+                    static_cast<float>(samples_per_pixel);
 
       float r, g, b;
 
@@ -112,71 +219,337 @@ void Camera::render(const hittable &world, const hittable &lights,
                     static_cast<uchar>(256 * std::clamp(g, 0.f, 0.999f)),
                     static_cast<uchar>(256 * std::clamp(r, 0.f, 0.999f)));
     }
+  }
 
-    int local_completed;
-#pragma omp atomic capture
-    {
-      completed_rows++;
-      local_completed = completed_rows;
-    }
+  if (visual_bvh) {
+    long long rays =
+        static_cast<long long>(image_width) * image_height * samples_per_pixel;
+    printf("网格遍历平均每条主光线访问: %.1f 字节\n",
+           static_cast<double>(total_bytes) / static_cast<double>(rays));
+  }
+  cv::imwrite(visual_bvh ? "bvh_heatmap_" + output_name : output_name, img);
+}
 
-    if (local_completed % 2 == 0 || local_completed == image_height) {
-#pragma omp critical
-      {
-        auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<float> elapsed = now - start;
-        float progress = (float)local_completed / image_height;
-        float remaining = (elapsed.count() / progress) - elapsed.count();
-        printf("\r渲染进度: %.2f%% | 已用时间: %.1fs | 预计剩余: %.1fs  ",
-               progress * 100, elapsed.count(),
-               remaining > 0.0f ? remaining : 0.0f);
+void Camera::train_guide(const hittable &world, const hittable &lights) {
+  AABB bounds;
+  if (!world.bounding_box(0.0f, 1.0f, bounds)) {
+    std::cerr << "路径引导: 场景没有包围盒，不启用。" << std::endl;
+    return;
+  }
+  guide = std::make_shared<PathGuide>(bounds);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < guiding_passes; ++k) {
+    const int pass_spp = 1 << std::min(k, 16);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int j = image_height - 1; j >= 0; --j) {
+      for (int i = 0; i < image_width; ++i) {
+        for (int s = 0; s < pass_spp; ++s) {
+          float u = (i + tracer::math::random_float()) / (image_width - 1),
+                v = (j + tracer::math::random_float()) / (image_height - 1);
+          ray_color(get_ray(u, v), background, world, lights, max_depth);
+        }
       }
     }
+    guide->refine(pass_spp);
+
+    std::chrono::duration<float> elapsed =
+        std::chrono::steady_clock::now() - start;
+    printf("路径引导训练: 第 %d/%d 轮 (%d spp) | 已用时间: %.1fs\n", k + 1,
+           guiding_passes, pass_spp, elapsed.count());
   }
-  printf("\n");
-  cv::imwrite(visual_bvh ? "bvh_heatmap_" + output_name : output_name, img);
+  guide->recording = false;
+}
+
+// 掠射角下面光源的 pdf 会趋于 inf；-ffast-math 下 isinf/isnan 会被优化掉，
+// 因此统一用比较截断到有限范围
+static constexpr float PDF_MAX = 1e18f;
+
+static bool valid_pdf(float pdf) { return pdf > 1e-4f && pdf < PDF_MAX; }
+
+// 功率启发式 (beta = 2)
+static float power_heuristic(float f_pdf, float g_pdf) {
+  float f = f_pdf < PDF_MAX ? f_pdf : PDF_MAX;
+  float g = g_pdf < PDF_MAX ? g_pdf : PDF_MAX;
+  float f2 = f * f;
+  float g2 = g * g;
+  if (f2 + g2 <= 0.0f)
+    return 0.0f;
+  return f2 / (f2 + g2);
 }
 
 Color Camera::ray_color(const Ray &r,
                         const std::shared_ptr<Background> &background,
                         const hittable &world, const hittable &lights,
                         int depth) {
+  return ray_color(r, background, world, lights, depth, 0.0f,
+                   PathState::Camera);
+}
+
+Color Camera::ray_color(const Ray &r,
+                        const std::shared_ptr<Background> &background,
+                        const hittable &world, const hittable &lights,
+                        int depth, float bsdf_pdf, PathState state) {
   if (depth <= 0)
     return Color(0.0f, 0.0f, 0.0f);
 
   hit_record rec;
   bool hit_surface = world.hit(r, 0.001f, tracer::math::INF, rec);
 
+  // 光锥沿路径传递：次级光线从命中点处的宽度出发，沿用相机的像素张角，
+  // 不考虑曲率与 BSDF 波瓣带来的扩张
+  float cone_width = 0.0f;
+  if (hit_surface) {
+    cone_width =
+        r.cone_width + r.cone_spread * rec.t * r.direction().length();
+    rec.uv_footprint = cone_footprint(r, rec, cone_width);
+  }
+
+  // BSDF 采样命中光源（或逃逸到背景）时，该点也可能被上一层的光源采样
+  // 采到，需要按 MIS 权重折算，避免重复计算。RIS 已经把 BSDF 候选纳入
+  // 重采样，光源能采到的方向全部由它负责
+  auto bsdf_weight = [&]() {
+    if (bsdf_pdf <= 0.0f)
+      return 1.0f;
+    float light_pdf = hit_surface
+                          ? lights.light_pdf(r.origin(), r.direction(), rec)
+                          : lights.pdf_value(r.origin(), r.direction());
+    if (direct_lighting == DirectLighting::RIS)
+      return valid_pdf(light_pdf) ? 0.0f : 1.0f;
+    return power_heuristic(bsdf_pdf, light_pdf);
+  };
+
+  // 焦散路径上的太阳圆盘与光源已经发射过光子，只保留天空本身
   if (!hit_surface) {
-    return background->value(r);
+    if (state == PathState::Caustic)
+      return background->value(r);
+    Color bg = background->radiance(r);
+    if (bg.r() + bg.g() + bg.b() <= 0.0f)
+      return bg;
+    return bsdf_weight() * bg;
   }
 
   scatter_record srec;
   Color emitted = rec.mat_ptr->emitted(r, rec, rec.u, rec.v, rec.p);
+  if (emitted.r() + emitted.g() + emitted.b() > 0.0f) {
+    if (state == PathState::Caustic &&
+        lights.light_pdf(r.origin(), r.direction(), rec) > 0.0f)
+      emitted = Color(0.0f, 0.0f, 0.0f);
+    else
+      emitted *= bsdf_weight();
+  }
 
-  if (!rec.mat_ptr->scatter(r, rec, srec))
+  // 最后一次弹射之后的路径 BSDF 采样已经无法到达，光源采样也不再做，
+  // 否则两种策略覆盖的路径长度不一致
+  if (depth <= 1 || !rec.mat_ptr->scatter(r, rec, srec))
     return emitted;
 
   if (srec.is_specular) {
-    return emitted + srec.attenuation * ray_color(srec.specular_ray, background,
-                                                  world, lights, depth - 1);
+    PathState next =
+        state == PathState::Camera ? PathState::Camera : PathState::Caustic;
+    Ray specular = srec.specular_ray;
+    specular.cone_width = cone_width;
+    specular.cone_spread = r.cone_spread;
+    return emitted + srec.attenuation * ray_color(specular, background, world,
+                                                  lights, depth - 1, 0.0f,
+                                                  next);
   }
 
-  std::shared_ptr<Hittable_pdf> light_ptr =
-      std::make_shared<Hittable_pdf>(lights, rec.p);
-  Mixture_pdf p(light_ptr, srec.pdf_ptr);
+  // 辐亮度缓存：足够深的漫反射顶点直接取缓存的出射辐亮度并终止，
+  // 更浅的顶点把完整估计写回缓存
+  const bool cacheable = radiance_cache && rec.mat_ptr->is_diffuse();
+  const int bounce = max_depth - depth;
+  if (cacheable && bounce >= radiance_cache_depth) {
+    Color cached;
+    if (radiance_cache->lookup(rec.p, rec.normal, cached))
+      return emitted + srec.attenuation * cached;
+  }
 
-  Ray scattered = Ray(rec.p, p.generate());
-  float pdf_val = p.value(scattered.direction());
-  if (pdf_val < 1e-4f || std::isnan(pdf_val) || std::isinf(pdf_val)) {
-    return emitted;
+  // 介质中的散射点没有表面，焦散仍由路径追踪负责
+  Color caustic(0.0f, 0.0f, 0.0f);
+  PathState next = PathState::Camera;
+  if (photons && !rec.mat_ptr->is_volumetric()) {
+    caustic = photons->estimate(r, rec, srec);
+    next = PathState::Diffuse;
+  }
+
+  // 路径引导：按学到的入射辐亮度分布与 BSDF 混合采样，
+  // 光源采样的 MIS 权重也按混合后的概率密度计算
+  if (guide && guide->can_sample()) {
+    if (auto guided = guide->pdf(rec.p))
+      srec.pdf_ptr = std::make_shared<Mixture_pdf>(
+          guided, srec.pdf_ptr, PathGuide::GUIDE_FRACTION);
+  }
+
+  Color direct =
+      direct_lighting == DirectLighting::RIS
+          ? sample_direct_ris(r, rec, srec, background, world, lights)
+          : sample_direct(r, rec, srec, background, world, lights);
+
+  Ray scattered = Ray(rec.p, srec.pdf_ptr->generate());
+  scattered.cone_width = cone_width;
+  scattered.cone_spread = r.cone_spread;
+  float pdf_val = srec.pdf_ptr->value(scattered.direction());
+  if (!valid_pdf(pdf_val)) {
+    return emitted + direct + caustic;
+  }
+
+  Color incoming = ray_color(scattered, background, world, lights, depth - 1,
+                             pdf_val, next);
+  if (guide && guide->recording) {
+    float lum = 0.2126f * incoming.r() + 0.7152f * incoming.g() +
+                0.0722f * incoming.b();
+    guide->record(rec.p, scattered.direction(), lum / pdf_val);
+  }
+
+  Color reflected =
+      direct + caustic +
+      srec.attenuation * rec.mat_ptr->scattering_pdf(r, rec, srec, scattered) *
+          incoming / pdf_val;
+  if (cacheable && bounce <= radiance_cache_depth) {
+    // 缓存与反照率无关的部分，反照率为 0 的通道无法还原，记为 0
+    Color value;
+    for (int c = 0; c < 3; ++c) {
+      float a = srec.attenuation[c];
+      value[c] = a > 1e-4f ? reflected[c] / a : 0.0f;
+    }
+    radiance_cache->record(rec.p, rec.normal, value);
+  }
+
+  return emitted + reflected;
+}
+
+Color Camera::sample_direct(const Ray &r, const hit_record &rec,
+                            const scatter_record &srec,
+                            const std::shared_ptr<Background> &background,
+                            const hittable &world, const hittable &lights) {
+  Vec3 to_light = lights.random(rec.p) - rec.p;
+  float dist = to_light.length();
+  if (!(dist > 1e-4f))
+    return Color(0.0f, 0.0f, 0.0f);
+  Ray shadow(rec.p, to_light / dist, r.time());
+
+  Color f = srec.attenuation * rec.mat_ptr->scattering_pdf(r, rec, srec, shadow);
+  if (f.r() + f.g() + f.b() <= 0.0f)
+    return Color(0.0f, 0.0f, 0.0f);
+
+  // 遮挡测试：最近交点必须就是光源上的采样点（被其它物体或同一光源的
+  // 其它部分挡住都算遮挡）。未命中任何物体时取背景（含平行光的圆盘），
+  // 对应平行光以及只登记在 lights 中、用来指示太阳方向的物体
+  hit_record light_rec;
+  Color Le;
+  float light_val;
+  if (world.hit(shadow, 0.001f, tracer::math::INF, light_rec)) {
+    if (std::fabs(light_rec.t - dist) > 1e-3f * dist)
+      return Color(0.0f, 0.0f, 0.0f);
+    light_val = lights.light_pdf(rec.p, shadow.direction(), light_rec);
+    Le = light_rec.mat_ptr->emitted(shadow, light_rec, light_rec.u,
+                                    light_rec.v, light_rec.p);
+  } else {
+    light_val = lights.pdf_value(rec.p, shadow.direction());
+    Le = background->radiance(shadow);
+  }
+
+  if (!valid_pdf(light_val) || Le.r() + Le.g() + Le.b() <= 0.0f)
+    return Color(0.0f, 0.0f, 0.0f);
+
+  float bsdf_val = srec.pdf_ptr->value(shadow.direction());
+  return power_heuristic(light_val, bsdf_val) * f * Le / light_val;
+}
+
+// RIS 的一个候选方向。t 为光源上交点的距离，逃逸到背景时为 INF
+struct LightCandidate {
+  Vec3 dir;
+  float t = 0.0f;
+  Color f;      // BSDF 值（含余弦项）
+  float target; // 未遮挡贡献 f * Le 的亮度
+};
+
+Color Camera::sample_direct_ris(const Ray &r, const hit_record &rec,
+                                const scatter_record &srec,
+                                const std::shared_ptr<Background> &background,
+                                const hittable &world, const hittable &lights) {
+  const int light_count = std::max(1, ris_candidates);
+
+  // 只与 lights 求交来估计未遮挡贡献，比一次完整的场景遮挡测试便宜得多。
+  // 没有自发光的光源（只用来指示太阳方向的物体）与 sample_direct 一致
+  // 取背景辐亮度
+  auto evaluate = [&](const Vec3 &dir, float dist, LightCandidate &c) {
+    c.dir = dir;
+    c.target = 0.0f;
+    Ray probe(rec.p, dir, r.time());
+    // BSDF 为 0（如背面）的候选不必再与光源求交
+    c.f = srec.attenuation * rec.mat_ptr->scattering_pdf(r, rec, srec, probe);
+    if (c.f.r() + c.f.g() + c.f.b() <= 0.0f)
+      return 0.0f;
+
+    hit_record light_rec;
+    Color Le;
+    float light_val;
+    if (lights.hit(probe, 0.001f, tracer::math::INF, light_rec)) {
+      if (dist < tracer::math::INF &&
+          std::fabs(light_rec.t - dist) > 1e-3f * dist)
+        return 0.0f;
+      c.t = light_rec.t;
+      light_val = lights.light_pdf(rec.p, dir, light_rec);
+      Le = light_rec.mat_ptr->emitted(probe, light_rec, light_rec.u,
+                                      light_rec.v, light_rec.p);
+      if (Le.r() + Le.g() + Le.b() <= 0.0f)
+        Le = background->radiance(probe);
+    } else {
+      c.t = tracer::math::INF;
+      light_val = lights.pdf_value(rec.p, dir);
+      Le = background->radiance(probe);
+    }
+    if (!valid_pdf(light_val))
+      return 0.0f;
+
+    Color contrib = c.f * Le;
+    c.target = 0.2126f * contrib.r() + 0.7152f * contrib.g() +
+               0.0722f * contrib.b();
+    if (!(c.target > 0.0f))
+      return 0.0f;
+
+    // 平衡启发式下的候选权重：target / (M_l * p_l + M_b * p_b)
+    float bsdf_val = srec.pdf_ptr->value(dir);
+    float bsdf_term = bsdf_val < PDF_MAX ? bsdf_val : PDF_MAX;
+    return c.target / (light_count * light_val + bsdf_term);
+  };
+
+  math::Reservoir<LightCandidate> reservoir;
+  LightCandidate c;
+  for (int i = 0; i < light_count; ++i) {
+    Vec3 to_light = lights.random(rec.p) - rec.p;
+    float dist = to_light.length();
+    if (!(dist > 1e-4f))
+      continue;
+    float w = evaluate(to_light / dist, dist, c);
+    reservoir.update(c, w, tracer::math::random_float());
+  }
+  Vec3 bsdf_dir = srec.pdf_ptr->generate();
+  if (valid_pdf(srec.pdf_ptr->value(bsdf_dir))) {
+    float w = evaluate(unit_vector(bsdf_dir), tracer::math::INF, c);
+    reservoir.update(c, w, tracer::math::random_float());
+  }
+  if (reservoir.empty())
+    return Color(0.0f, 0.0f, 0.0f);
+
+  // 只对选中的候选做一次遮挡测试，辐亮度按 sample_direct 的规则取自场景
+  const LightCandidate &y = reservoir.y;
+  Ray shadow(rec.p, y.dir, r.time());
+  hit_record light_rec;
+  Color Le;
+  if (world.hit(shadow, 0.001f, tracer::math::INF, light_rec)) {
+    if (!(y.t < tracer::math::INF) ||
+        std::fabs(light_rec.t - y.t) > 1e-3f * y.t)
+      return Color(0.0f, 0.0f, 0.0f);
+    Le = light_rec.mat_ptr->emitted(shadow, light_rec, light_rec.u,
+                                    light_rec.v, light_rec.p);
+  } else {
+    Le = background->radiance(shadow);
   }
 
-  return emitted +
-         srec.attenuation *
-             rec.mat_ptr->scattering_pdf(r, rec, srec, scattered) *
-             ray_color(scattered, background, world, lights, depth - 1) /
-             pdf_val;
+  return y.f * Le * (reservoir.w_sum / y.target);
 }
 
-} // namespace tracer
\ No newline at end of file
+} // namespace tracer
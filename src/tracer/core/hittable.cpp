@@ -1,4 +1,7 @@
 #include "tracer/core/hittable.h"
+#include "tracer/core/material.h"
+#include "tracer/core/onb.h"
+#include "tracer/math/sampling.h"
 
 namespace tracer {
 
@@ -7,6 +10,57 @@ void hit_record::set_face_normal(const Ray &r, const Vec3 &outward_normal) {
   normal = front_face ? outward_normal : -outward_normal;
 }
 
+float hittable::light_pdf(const Point3 &o, const Vec3 &v,
+                          const hit_record &rec) const {
+  hit_record self;
+  if (!hit(Ray(o, v), 0.001f, math::INF, self))
+    return 0.0f;
+  if (std::fabs(self.t - rec.t) > 1e-3f * rec.t + 1e-4f)
+    return 0.0f;
+  return pdf_value(o, v);
+}
+
+float hittable::emitted_power() const {
+  auto mat = get_material();
+  AABB box;
+  if (!mat || !bounding_box(0.0f, 0.0f, box))
+    return 0.0f;
+  Color e = mat->average_emission();
+  float luminance = 0.2126f * e.r() + 0.7152f * e.g() + 0.0722f * e.b();
+  return luminance * 0.5f * box.surface_area();
+}
+
+bool hittable::emit_photon(const AABB &scene, Ray &ray, Color &flux) const {
+  hit_record rec;
+  float pdf = sample_surface(rec);
+  if (!(pdf > 0.0f) || !rec.mat_ptr)
+    return false;
+
+  // 单面发光时只向法线方向锥一侧发射，否则两侧各占一半
+  Vec3 n = rec.normal;
+  float sides = 2.0f;
+  Vec3 axis;
+  float cos_theta_o;
+  if (emission_cone(axis, cos_theta_o)) {
+    sides = 1.0f;
+    if (dot(n, axis) < 0.0f)
+      n = -n;
+  } else if (math::random_float() < 0.5f) {
+    n = -n;
+  }
+
+  onb uvw;
+  uvw.build_from_w(n);
+  Vec3 dir = uvw.local(math::random_cosine_direction());
+  ray = Ray(rec.p, dir);
+
+  // Le * cos / (pdf_A * cos / (pi * sides))
+  Color Le = rec.mat_ptr->emitted(Ray(rec.p + dir, -dir), rec, rec.u, rec.v,
+                                  rec.p);
+  flux = Le * (sides * math::TRACER_PI / pdf);
+  return Le.r() + Le.g() + Le.b() > 0.0f;
+}
+
 bool FlipFace::hit(const Ray &r, float t_min, float t_max,
                     hit_record &rec) const {
 
@@ -28,4 +82,10 @@ float FlipFace::pdf_value(const Point3 &o, const Vec3 &v) const {
 
 Vec3 FlipFace::random(const Vec3 &o) const { return ptr->random(o); }
 
+float FlipFace::sample_surface(hit_record &rec) const {
+  float pdf = ptr->sample_surface(rec);
+  rec.normal = -rec.normal;
+  return pdf;
+}
+
 } // namespace tracer
\ No newline at end of file
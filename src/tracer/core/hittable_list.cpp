@@ -44,6 +44,17 @@ float hittable_list::pdf_value(const Point3 &o, const Vec3 &v) const {
   return sum;
 }
 
+float hittable_list::light_pdf(const Point3 &o, const Vec3 &v,
+                               const hit_record &rec) const {
+  float weight = 1.0f / static_cast<float>(objects.size());
+  float sum = 0.0f;
+
+  for (const auto &object : objects)
+    sum += weight * object->light_pdf(o, v, rec);
+
+  return sum;
+}
+
 Vec3 hittable_list::random(const Vec3 &o) const {
   const int int_size = static_cast<int>(objects.size());
   if (int_size <= 0) {
@@ -54,4 +65,24 @@ Vec3 hittable_list::random(const Vec3 &o) const {
   return objects[idx]->random(o);
 }
 
+float hittable_list::sample_surface(hit_record &rec) const {
+  const int int_size = static_cast<int>(objects.size());
+  if (int_size <= 0)
+    return 0.0f;
+  int idx = std::clamp(math::random_int(0, int_size - 1), 0, int_size - 1);
+  return objects[idx]->sample_surface(rec) / static_cast<float>(int_size);
+}
+
+bool hittable_list::emit_photon(const AABB &scene, Ray &ray,
+                                Color &flux) const {
+  const int int_size = static_cast<int>(objects.size());
+  if (int_size <= 0)
+    return false;
+  int idx = std::clamp(math::random_int(0, int_size - 1), 0, int_size - 1);
+  if (!objects[idx]->emit_photon(scene, ray, flux))
+    return false;
+  flux *= static_cast<float>(int_size);
+  return true;
+}
+
 } // namespace tracer
\ No newline at end of file
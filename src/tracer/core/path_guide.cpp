@@ -0,0 +1,235 @@
+#include "tracer/core/path_guide.h"
+
+namespace tracer {
+
+// 空间叶子的分裂阈值为 c * sqrt(本轮每像素样本数)，取自原论文
+static constexpr float SPATIAL_SPLIT_C = 12000.0f;
+
+// 能量超过总量 1% 的象限继续细分，最大深度 20 层
+static constexpr float DTREE_THRESHOLD = 0.01f;
+static constexpr int DTREE_MAX_DEPTH = 20;
+
+// 单位方向 <-> [0, 1]² 的等面积映射：u = (cos(theta) + 1) / 2，
+// v = phi / 2pi，正方形上的均匀分布对应球面上的均匀分布
+static void dir_to_square(const Vec3 &dir, float &u, float &v) {
+  Vec3 d = unit_vector(dir);
+  float cos_theta = std::clamp(d.z(), -1.0f, 1.0f);
+  float phi = std::atan2(d.y(), d.x());
+  if (phi < 0.0f)
+    phi += 2.0f * math::TRACER_PI;
+  u = std::clamp(0.5f * (cos_theta + 1.0f), 0.0f, 0.99999994f);
+  v = std::clamp(phi / (2.0f * math::TRACER_PI), 0.0f, 0.99999994f);
+}
+
+static Vec3 square_to_dir(float u, float v) {
+  float cos_theta = 2.0f * u - 1.0f;
+  float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+  float phi = 2.0f * math::TRACER_PI * v;
+  return Vec3(sin_theta * std::cos(phi), sin_theta * std::sin(phi),
+              cos_theta);
+}
+
+// 取 (u, v) 所在的象限，并把坐标变换到该象限内的 [0, 1]²
+static int child_quadrant(float &u, float &v) {
+  int q = 0;
+  if (u >= 0.5f) {
+    q |= 1;
+    u -= 0.5f;
+  }
+  if (v >= 0.5f) {
+    q |= 2;
+    v -= 0.5f;
+  }
+  u *= 2.0f;
+  v *= 2.0f;
+  return q;
+}
+
+DTree::DTree() : nodes(1) {}
+
+float DTree::total() const {
+  const Node &root = nodes[0];
+  return root.sum[0] + root.sum[1] + root.sum[2] + root.sum[3];
+}
+
+void DTree::record(const Vec3 &dir, float radiance) {
+  float u, v;
+  dir_to_square(dir, u, v);
+  uint32_t idx = 0;
+  while (true) {
+    int q = child_quadrant(u, v);
+    float &sum = nodes[idx].sum[q];
+#pragma omp atomic
+    sum += radiance;
+    if (nodes[idx].child[q] == 0)
+      break;
+    idx = nodes[idx].child[q];
+  }
+}
+
+float DTree::pdf(const Vec3 &dir) const {
+  if (!(total() > 0.0f))
+    return 0.0f;
+
+  float u, v;
+  dir_to_square(dir, u, v);
+  float pdf = 1.0f;
+  uint32_t idx = 0;
+  while (true) {
+    const Node &node = nodes[idx];
+    float node_total = node.sum[0] + node.sum[1] + node.sum[2] + node.sum[3];
+    int q = child_quadrant(u, v);
+    if (!(node.sum[q] > 0.0f))
+      return 0.0f;
+    pdf *= 4.0f * node.sum[q] / node_total;
+    if (node.child[q] == 0)
+      break;
+    idx = node.child[q];
+  }
+  // 正方形的面积为 1，球面的面积为 4pi
+  return pdf / (4.0f * math::TRACER_PI);
+}
+
+Vec3 DTree::sample() const {
+  if (!(total() > 0.0f))
+    return square_to_dir(math::random_float(), math::random_float());
+
+  float u0 = 0.0f, v0 = 0.0f, size = 1.0f;
+  uint32_t idx = 0;
+  while (true) {
+    const Node &node = nodes[idx];
+    float node_total = node.sum[0] + node.sum[1] + node.sum[2] + node.sum[3];
+    float x = math::random_float() * node_total;
+    int q = -1;
+    for (int i = 0; i < 4; ++i) {
+      if (!(node.sum[i] > 0.0f))
+        continue;
+      q = i; // 舍入误差导致 x 越过总和时落在最后一个非空象限
+      if (x < node.sum[i])
+        break;
+      x -= node.sum[i];
+    }
+    if (q < 0)
+      break;
+    size *= 0.5f;
+    u0 += (q & 1) ? size : 0.0f;
+    v0 += (q & 2) ? size : 0.0f;
+    if (node.child[q] == 0)
+      break;
+    idx = node.child[q];
+  }
+  return square_to_dir(u0 + size * math::random_float(),
+                       v0 + size * math::random_float());
+}
+
+uint32_t DTree::build(DTree &out, int src, float energy, float min_energy,
+                      int depth, int max_depth) const {
+  uint32_t idx = static_cast<uint32_t>(out.nodes.size());
+  out.nodes.emplace_back();
+  for (int q = 0; q < 4; ++q) {
+    // 原来的叶子没有下一层的统计，按均匀分布估计
+    int child = src >= 0 ? static_cast<int>(nodes[src].child[q]) : -1;
+    float e = src >= 0 ? nodes[src].sum[q] : 0.25f * energy;
+    if (child == 0)
+      child = -1;
+    if (depth < max_depth && e > min_energy) {
+      uint32_t c = build(out, child, e, min_energy, depth + 1, max_depth);
+      out.nodes[idx].child[q] = c;
+    }
+  }
+  return idx;
+}
+
+DTree DTree::refined(float threshold, int max_depth) const {
+  DTree out;
+  float t = total();
+  if (!(t > 0.0f))
+    return out;
+  out.nodes.clear();
+  build(out, 0, t, threshold * t, 1, max_depth);
+  return out;
+}
+
+PathGuide::PathGuide(const AABB &bounds)
+    : bounds(bounds), nodes(1), leaves(1) {}
+
+uint32_t PathGuide::leaf_index(const Point3 &p) const {
+  Point3 lo = bounds.min, hi = bounds.max;
+  uint32_t idx = 0;
+  while (nodes[idx].child[0] != 0) {
+    const SpatialNode &node = nodes[idx];
+    float mid = 0.5f * (lo[node.axis] + hi[node.axis]);
+    if (p[node.axis] < mid) {
+      hi[node.axis] = mid;
+      idx = node.child[0];
+    } else {
+      lo[node.axis] = mid;
+      idx = node.child[1];
+    }
+  }
+  return nodes[idx].leaf;
+}
+
+void PathGuide::record(const Point3 &p, const Vec3 &dir, float radiance) {
+  if (!(radiance > 0.0f) || !(radiance < 1e18f))
+    return;
+  Leaf &leaf = leaves[leaf_index(p)];
+  leaf.building.record(dir, radiance);
+#pragma omp atomic
+  leaf.samples++;
+}
+
+std::shared_ptr<PDF> PathGuide::pdf(const Point3 &p) const {
+  const DTree &tree = leaves[leaf_index(p)].sampling;
+  if (!(tree.total() > 0.0f))
+    return nullptr;
+  return std::make_shared<Guided_pdf>(tree);
+}
+
+void PathGuide::refine(int pass_spp) {
+  // 空间树：样本数超过阈值的叶子沿轴对半分，两个子节点沿用父节点的统计，
+  // 样本数各取一半，直到低于阈值
+  const float split =
+      SPATIAL_SPLIT_C * std::sqrt(static_cast<float>(pass_spp));
+  std::vector<uint32_t> stack;
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].child[0] == 0)
+      stack.push_back(i);
+  }
+  while (!stack.empty()) {
+    uint32_t idx = stack.back();
+    stack.pop_back();
+    uint32_t leaf = nodes[idx].leaf;
+    if (leaves[leaf].samples <= split)
+      continue;
+
+    leaves[leaf].samples /= 2;
+    uint32_t extra = static_cast<uint32_t>(leaves.size());
+    leaves.push_back(leaves[leaf]);
+
+    int axis = (nodes[idx].axis + 1) % 3;
+    uint32_t c0 = static_cast<uint32_t>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    nodes[c0].axis = axis;
+    nodes[c0].leaf = leaf;
+    nodes[c0 + 1].axis = axis;
+    nodes[c0 + 1].leaf = extra;
+    nodes[idx].child[0] = c0;
+    nodes[idx].child[1] = c0 + 1;
+    stack.push_back(c0);
+    stack.push_back(c0 + 1);
+  }
+
+  // 方向树：本轮统计成为采样分布，按它的能量分布调整下一轮的结构
+#pragma omp parallel for schedule(dynamic, 16)
+  for (int i = 0; i < static_cast<int>(leaves.size()); ++i) {
+    Leaf &leaf = leaves[i];
+    DTree next = leaf.building.refined(DTREE_THRESHOLD, DTREE_MAX_DEPTH);
+    leaf.sampling = std::move(leaf.building);
+    leaf.building = std::move(next);
+    leaf.samples = 0;
+  }
+  ++iteration;
+}
+
+} // namespace tracer
@@ -0,0 +1,164 @@
+#include "tracer/core/photon_map.h"
+
+namespace tracer {
+
+// 自动估计半径时，希望每次查询平均覆盖的光子数
+static constexpr float PHOTONS_PER_QUERY = 20.0f;
+
+void PhotonMap::build(const hittable &world, const hittable &lights,
+                      const AABB &scene, int count, int max_depth,
+                      float radius) {
+  trace(world, lights, scene, count, max_depth);
+
+  search_radius = radius;
+  if (!(search_radius > 0.0f)) {
+    // 光子一般落在少数几个表面上，取其包围盒表面积的一半作为面积估计
+    float area = 0.0f;
+    if (!photons.empty()) {
+      AABB box(photons[0].p, photons[0].p);
+      for (const Photon &photon : photons)
+        box.expand(photon.p);
+      area = 0.5f * box.surface_area();
+    }
+    if (area > 0.0f) {
+      search_radius = std::sqrt(area * PHOTONS_PER_QUERY /
+                                (math::TRACER_PI * photons.size()));
+    } else {
+      search_radius = 1e-3f * (scene.max - scene.min).length();
+    }
+  }
+  inv_cell = 0.5f / search_radius;
+
+  build_grid();
+}
+
+void PhotonMap::trace(const hittable &world, const hittable &lights,
+                      const AABB &scene, int count, int max_depth) {
+  photons.clear();
+  const float inv_count = 1.0f / static_cast<float>(count);
+
+#pragma omp parallel
+  {
+    std::vector<Photon> local;
+#pragma omp for schedule(dynamic, 1024)
+    for (int i = 0; i < count; ++i) {
+      Ray ray;
+      Color flux;
+      if (!lights.emit_photon(scene, ray, flux))
+        continue;
+      flux *= inv_count;
+
+      bool specular = false;
+      for (int depth = 0; depth < max_depth; ++depth) {
+        hit_record rec;
+        if (!world.hit(ray, 0.001f, tracer::math::INF, rec))
+          break;
+        scatter_record srec;
+        if (!rec.mat_ptr->scatter(ray, rec, srec))
+          break;
+
+        // 第一次落到非镜面表面就结束：没有经过镜面的是直接光照，
+        // 由光源采样负责；介质中的散射点没有表面，不做表面密度估计
+        if (!srec.is_specular) {
+          if (specular && !rec.mat_ptr->is_volumetric())
+            local.push_back({rec.p, -unit_vector(ray.direction()), flux});
+          break;
+        }
+        specular = true;
+        flux = flux * srec.attenuation;
+        ray = srec.specular_ray;
+      }
+    }
+#pragma omp critical
+    photons.insert(photons.end(), local.begin(), local.end());
+  }
+}
+
+uint32_t PhotonMap::bucket(int x, int y, int z) const {
+  uint32_t h = static_cast<uint32_t>(x) * 73856093u ^
+               static_cast<uint32_t>(y) * 19349663u ^
+               static_cast<uint32_t>(z) * 83492791u;
+  return h & mask;
+}
+
+void PhotonMap::build_grid() {
+  const size_t n = photons.size();
+  size_t table = 1;
+  while (table < 2 * n)
+    table <<= 1;
+  mask = static_cast<uint32_t>(table - 1);
+
+  // 计数排序：统计每个桶的光子数，前缀和得到起始位置，再并行写入
+  std::vector<uint32_t> keys(n);
+  std::vector<uint32_t> counts(table, 0);
+#pragma omp parallel for
+  for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+    const Point3 &p = photons[i].p;
+    keys[i] = bucket(static_cast<int>(std::floor(p.x() * inv_cell)),
+                     static_cast<int>(std::floor(p.y() * inv_cell)),
+                     static_cast<int>(std::floor(p.z() * inv_cell)));
+    uint32_t &c = counts[keys[i]];
+#pragma omp atomic
+    c++;
+  }
+
+  cell_start.assign(table + 1, 0);
+  for (size_t k = 0; k < table; ++k)
+    cell_start[k + 1] = cell_start[k] + counts[k];
+
+  std::vector<uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+  std::vector<Photon> sorted(n);
+#pragma omp parallel for
+  for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+    uint32_t slot;
+    uint32_t &c = cursor[keys[i]];
+#pragma omp atomic capture
+    slot = c++;
+    sorted[slot] = photons[i];
+  }
+  photons.swap(sorted);
+}
+
+Color PhotonMap::estimate(const Ray &r, const hit_record &rec,
+                          const scatter_record &srec) const {
+  Color sum(0.0f, 0.0f, 0.0f);
+  if (photons.empty())
+    return sum;
+
+  const float r2 = search_radius * search_radius;
+  int x0 = static_cast<int>(std::floor((rec.p.x() - search_radius) * inv_cell));
+  int y0 = static_cast<int>(std::floor((rec.p.y() - search_radius) * inv_cell));
+  int z0 = static_cast<int>(std::floor((rec.p.z() - search_radius) * inv_cell));
+
+  // 不同格子可能散列到同一个桶，同一个桶只累加一次
+  uint32_t visited[8];
+  int visited_count = 0;
+  for (int dx = 0; dx < 2; ++dx) {
+    for (int dy = 0; dy < 2; ++dy) {
+      for (int dz = 0; dz < 2; ++dz) {
+        uint32_t b = bucket(x0 + dx, y0 + dy, z0 + dz);
+        if (std::find(visited, visited + visited_count, b) !=
+            visited + visited_count)
+          continue;
+        visited[visited_count++] = b;
+
+        for (uint32_t k = cell_start[b]; k < cell_start[b + 1]; ++k) {
+          const Photon &photon = photons[k];
+          if ((photon.p - rec.p).squared_length() > r2)
+            continue;
+          // 只接受从表面同一侧射来的光子，避免薄物体两侧互相漏光
+          float cos_theta = dot(photon.wi, rec.normal);
+          if (cos_theta < 1e-3f)
+            continue;
+          // 材质的 scattering_pdf 含余弦项，除掉后得到 BSDF
+          float f = rec.mat_ptr->scattering_pdf(r, rec, srec,
+                                                Ray(rec.p, photon.wi));
+          sum += photon.flux * (f / cos_theta);
+        }
+      }
+    }
+  }
+  return srec.attenuation * sum / (math::TRACER_PI * r2);
+}
+
+} // namespace tracer
@@ -0,0 +1,116 @@
+#include "tracer/core/radiance_cache.h"
+
+namespace tracer {
+
+// 2^20 个表项，约 24 MB
+static constexpr uint64_t TABLE_BITS = 20;
+static constexpr uint64_t TABLE_MASK = (uint64_t(1) << TABLE_BITS) - 1;
+static constexpr int MAX_PROBES = 16;
+
+// 每个坐标轴 20 位，以原点为中心
+static constexpr int64_t COORD_BIAS = int64_t(1) << 19;
+static constexpr int64_t COORD_MAX = (int64_t(1) << 20) - 1;
+
+static uint64_t hash64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+RadianceCache::RadianceCache(float cell_size)
+    : cell_size(cell_size), entries(TABLE_MASK + 1) {}
+
+uint64_t RadianceCache::make_key(const Point3 &p, const Vec3 &normal) const {
+  uint64_t key = 0;
+  for (int a = 0; a < 3; ++a) {
+    int64_t c =
+        static_cast<int64_t>(std::floor(p[a] / cell_size)) + COORD_BIAS;
+    c = std::clamp<int64_t>(c, 0, COORD_MAX);
+    key = (key << 20) | static_cast<uint64_t>(c);
+  }
+
+  // 法线量化为主轴方向的 6 个区间，墙角两侧的表面互不干扰
+  int axis = 0;
+  for (int a = 1; a < 3; ++a) {
+    if (std::fabs(normal[a]) > std::fabs(normal[axis]))
+      axis = a;
+  }
+  uint64_t bin = 2 * axis + (normal[axis] < 0.0f ? 1 : 0);
+  return ((key << 3) | bin) + 1;
+}
+
+void RadianceCache::record(const Point3 &p, const Vec3 &normal,
+                           const Color &value) {
+  // 丢掉 nan/inf 以及数值异常的样本，一个坏样本会永久污染整个格子
+  for (int c = 0; c < 3; ++c) {
+    if (!(value[c] >= 0.0f) || !(value[c] < 1e18f))
+      return;
+  }
+
+  const uint64_t key = make_key(p, normal);
+  uint64_t slot = hash64(key);
+  for (int probe = 0; probe < MAX_PROBES; ++probe, ++slot) {
+    Entry &entry = entries[slot & TABLE_MASK];
+    uint64_t current = entry.key.load(std::memory_order_relaxed);
+    if (current == 0) {
+      // 其它线程可能同时占用这个空位，失败时 current 为对方写入的键
+      if (entry.key.compare_exchange_strong(current, key,
+                                            std::memory_order_relaxed))
+        current = key;
+    }
+    if (current != key)
+      continue;
+
+    for (int c = 0; c < 3; ++c) {
+#pragma omp atomic
+      entry.sum[c] += value[c];
+    }
+#pragma omp atomic
+    entry.count += 1.0f;
+    return;
+  }
+  // 探测次数用完说明表已经很满，放弃这个样本
+}
+
+bool RadianceCache::lookup(const Point3 &p, const Vec3 &normal,
+                           Color &value) const {
+  const uint64_t key = make_key(p, normal);
+  uint64_t slot = hash64(key);
+  for (int probe = 0; probe < MAX_PROBES; ++probe, ++slot) {
+    const Entry &entry = entries[slot & TABLE_MASK];
+    uint64_t current = entry.key.load(std::memory_order_relaxed);
+    if (current == 0)
+      return false;
+    if (current != key)
+      continue;
+
+    // 其它线程正在用 omp atomic 累加这些值，读取也必须是原子的
+    float count, sum[3];
+#pragma omp atomic read
+    count = entry.count;
+    if (count < MIN_SAMPLES)
+      return false;
+    for (int c = 0; c < 3; ++c) {
+#pragma omp atomic read
+      sum[c] = entry.sum[c];
+    }
+    value = Color(sum[0], sum[1], sum[2]) / count;
+    return true;
+  }
+  return false;
+}
+
+void RadianceCache::decay(float keep) {
+#pragma omp parallel for
+  for (int64_t i = 0; i < static_cast<int64_t>(entries.size()); ++i) {
+    Entry &entry = entries[i];
+    for (int c = 0; c < 3; ++c)
+      entry.sum[c] *= keep;
+    entry.count *= keep;
+  }
+}
+
+} // namespace tracer
@@ -25,6 +25,20 @@ Vec3 XYRect::random(const Point3 &origin) const {
                 tracer::math::random_float(y0, y1), k);
 }
 
+float XYRect::sample_surface(hit_record &rec) const {
+  float x = tracer::math::random_float(x0, x1);
+  float y = tracer::math::random_float(y0, y1);
+  rec.p = Point3(x, y, k);
+  rec.normal = is_flipped ? Vec3(0, 0, -1) : Vec3(0, 0, 1);
+  rec.front_face = true;
+  rec.u = (x - x0) / (x1 - x0);
+  rec.v = (y - y0) / (y1 - y0);
+  rec.mat_ptr = mat_ptr;
+  rec.tangent = Vec3(1, 0, 0);
+  rec.bitangent = Vec3(0, 1, 0);
+  return 1.0f / ((x1 - x0) * (y1 - y0));
+}
+
 bool XYRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   float t = (k - r.origin().z()) / r.direction().z();
   if (t < t0 || t > t1)
@@ -36,6 +50,7 @@ bool XYRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   rec.u = (x - x0) / (x1 - x0);
   rec.v = (y - y0) / (y1 - y0);
   rec.t = t;
+  rec.uv_density = 1.0f / std::sqrt((x1 - x0) * (y1 - y0));
   rec.set_face_normal(r, is_flipped ? Vec3(0, 0, -1) : Vec3(0, 0, 1));
   rec.mat_ptr = mat_ptr;
   rec.p = r.at(t);
@@ -66,6 +81,20 @@ Vec3 XZRect::random(const Point3 &origin) const {
                 tracer::math::random_float(z0, z1));
 }
 
+float XZRect::sample_surface(hit_record &rec) const {
+  float x = tracer::math::random_float(x0, x1);
+  float z = tracer::math::random_float(z0, z1);
+  rec.p = Point3(x, k, z);
+  rec.normal = is_flipped ? Vec3(0, -1, 0) : Vec3(0, 1, 0);
+  rec.front_face = true;
+  rec.u = (x - x0) / (x1 - x0);
+  rec.v = (z - z0) / (z1 - z0);
+  rec.mat_ptr = mat_ptr;
+  rec.tangent = Vec3(1, 0, 0);
+  rec.bitangent = Vec3(0, 0, 1);
+  return 1.0f / ((x1 - x0) * (z1 - z0));
+}
+
 bool XZRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   float t = (k - r.origin().y()) / r.direction().y();
   if (t < t0 || t > t1)
@@ -77,6 +106,7 @@ bool XZRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   rec.u = (x - x0) / (x1 - x0);
   rec.v = (z - z0) / (z1 - z0);
   rec.t = t;
+  rec.uv_density = 1.0f / std::sqrt((x1 - x0) * (z1 - z0));
   rec.set_face_normal(r, is_flipped ? Vec3(0, -1, 0) : Vec3(0, 1, 0));
   rec.mat_ptr = mat_ptr;
   rec.p = r.at(t);
@@ -107,6 +137,20 @@ Vec3 YZRect::random(const Point3 &origin) const {
                 tracer::math::random_float(z0, z1));
 }
 
+float YZRect::sample_surface(hit_record &rec) const {
+  float y = tracer::math::random_float(y0, y1);
+  float z = tracer::math::random_float(z0, z1);
+  rec.p = Point3(k, y, z);
+  rec.normal = is_flipped ? Vec3(-1, 0, 0) : Vec3(1, 0, 0);
+  rec.front_face = true;
+  rec.u = (y - y0) / (y1 - y0);
+  rec.v = (z - z0) / (z1 - z0);
+  rec.mat_ptr = mat_ptr;
+  rec.tangent = Vec3(0, 1, 0);
+  rec.bitangent = Vec3(0, 0, 1);
+  return 1.0f / ((y1 - y0) * (z1 - z0));
+}
+
 bool YZRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   float t = (k - r.origin().x()) / r.direction().x();
   if (t < t0 || t > t1)
@@ -118,6 +162,7 @@ bool YZRect::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   rec.u = (y - y0) / (y1 - y0);
   rec.v = (z - z0) / (z1 - z0);
   rec.t = t;
+  rec.uv_density = 1.0f / std::sqrt((y1 - y0) * (z1 - z0));
   rec.set_face_normal(r, is_flipped ? Vec3(-1, 0, 0) : Vec3(1, 0, 0));
   rec.mat_ptr = mat_ptr;
   rec.p = r.at(t);
@@ -32,6 +32,15 @@ float Box::pdf_value(const Point3 &o, const Vec3 &v) const {
 
 Vec3 Box::random(const Point3 &o) const { return sides.random(o); }
 
+float Box::light_pdf(const Point3 &o, const Vec3 &v,
+                     const hit_record &rec) const {
+  return sides.light_pdf(o, v, rec);
+}
+
+float Box::sample_surface(hit_record &rec) const {
+  return sides.sample_surface(rec);
+}
+
 bool Box::hit(const Ray &r, float t0, float t1, hit_record &rec) const {
   return sides.hit(r, t0, t1, rec);
 }
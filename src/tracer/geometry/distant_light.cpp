@@ -0,0 +1,72 @@
+#include "tracer/geometry/distant_light.h"
+
+namespace tracer {
+namespace geometry {
+
+// 采样点放在这一距离处，远大于场景尺度，又不至于让 float 丢失方向精度
+static constexpr float DISTANT_LIGHT_FAR = 1e7f;
+
+DistantLight::DistantLight(const Vec3 &direction, float angular_radius,
+                           const Color &radiance)
+    : dir(unit_vector(direction)), radiance(radiance) {
+  // 角半径为 0 的理想平行光无法与 BSDF 采样做 MIS，这里限制一个下限
+  float degrees = std::clamp(angular_radius, 0.01f, 90.0f);
+  float theta = degrees * tracer::math::TRACER_PI / 180.f;
+  float s = std::sin(0.5f * theta);
+  one_minus_cos_max = 2.0f * s * s;
+  cos_max = 1.0f - one_minus_cos_max;
+  uvw.build_from_w(dir);
+}
+
+Color DistantLight::Le(const Vec3 &d) const {
+  if (dot(unit_vector(d), dir) < cos_max)
+    return Color(0.0f, 0.0f, 0.0f);
+  return radiance;
+}
+
+float DistantLight::pdf_value(const Point3 &o, const Vec3 &v) const {
+  if (dot(unit_vector(v), dir) < cos_max)
+    return 0.0f;
+  return 1.0f / solid_angle();
+}
+
+Vec3 DistantLight::random(const Point3 &o) const {
+  // 在方向锥内按立体角均匀采样：1 - cos 在 [0, 1 - cos_max] 上均匀分布
+  float one_minus_cos = math::random_float() * one_minus_cos_max;
+  float cos_theta = 1.0f - one_minus_cos;
+  float sin_theta =
+      std::sqrt(std::max(0.0f, one_minus_cos * (2.0f - one_minus_cos)));
+  float phi = 2.0f * tracer::math::TRACER_PI * math::random_float();
+  Vec3 w = uvw.local(sin_theta * std::cos(phi), sin_theta * std::sin(phi),
+                     cos_theta);
+  return o + DISTANT_LIGHT_FAR * w;
+}
+
+bool DistantLight::emit_photon(const AABB &scene, Ray &ray,
+                               Color &flux) const {
+  Point3 center = 0.5f * (scene.min + scene.max);
+  float radius = 0.5f * (scene.max - scene.min).length();
+  if (!(radius > 0.0f))
+    return false;
+
+  Vec3 w = unit_vector(random(Point3(0.0f, 0.0f, 0.0f)));
+  float r = radius * std::sqrt(math::random_float());
+  float phi = 2.0f * tracer::math::TRACER_PI * math::random_float();
+  Point3 origin = center + 2.0f * radius * dir +
+                  uvw.local(r * std::cos(phi), r * std::sin(phi), 0.0f);
+  ray = Ray(origin, -w);
+
+  // 辐亮度 x 立体角 x 圆盘面积 x 方向与圆盘法线的余弦
+  float disk_area = tracer::math::TRACER_PI * radius * radius;
+  flux = radiance * (solid_angle() * disk_area * dot(w, dir));
+  return true;
+}
+
+float DistantLight::emitted_power() const {
+  float luminance = 0.2126f * radiance.r() + 0.7152f * radiance.g() +
+                    0.0722f * radiance.b();
+  return luminance * solid_angle();
+}
+
+} // namespace geometry
+} // namespace tracer
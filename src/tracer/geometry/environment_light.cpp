@@ -0,0 +1,90 @@
+#include "tracer/geometry/environment_light.h"
+
+namespace tracer {
+namespace geometry {
+
+// 采样分布的网格上限，4K 贴图按 4x4 像素合并，别名表约占 4 MB
+static constexpr int MAX_GRID_U = 1024;
+static constexpr int MAX_GRID_V = 512;
+
+// 采样点放在这一距离处，阴影光线不被遮挡时会逃逸到背景
+static constexpr float ENVIRONMENT_LIGHT_FAR = 1e7f;
+
+EnvironmentLight::EnvironmentLight(
+    std::shared_ptr<const LatLongBackground> bg)
+    : background(std::move(bg)) {
+  if (!background || background->cols() < 1 || background->rows() < 1) {
+    std::cerr << "EnvironmentLight: 背景贴图为空，不参与光源采样。"
+              << std::endl;
+    return;
+  }
+
+  const int width = background->cols();
+  const int height = background->rows();
+  nu = std::min(width, MAX_GRID_U);
+  nv = std::min(height, MAX_GRID_V);
+
+  // 每格的权重取其覆盖格点（含双线性插值用到的右下边界）的平均亮度，
+  // 再乘上 sin(theta) 抵消等距柱状投影在两极的拉伸
+  std::vector<float> row_weights(nv);
+  conditional.resize(nv);
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int j = 0; j < nv; ++j) {
+    int y0 = j * height / nv;
+    int y1 = std::min(((j + 1) * height + nv - 1) / nv, height);
+    float sin_theta = std::sin(math::TRACER_PI * (j + 0.5f) / nv);
+
+    std::vector<float> weights(nu);
+    float row_sum = 0.0f;
+    for (int i = 0; i < nu; ++i) {
+      int x0 = i * width / nu;
+      int x1 = std::min(((i + 1) * width + nu - 1) / nu, width);
+      float sum = 0.0f;
+      for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x)
+          sum += background->luminance(x, y);
+      }
+      weights[i] = sum / static_cast<float>((x1 - x0 + 1) * (y1 - y0 + 1)) *
+                   sin_theta;
+      row_sum += weights[i];
+    }
+    conditional[j] = math::AliasTable(weights);
+    row_weights[j] = row_sum;
+  }
+  marginal = math::AliasTable(row_weights);
+
+  std::cout << "环境光采样分布: " << nu << "x" << nv << std::endl;
+}
+
+float EnvironmentLight::pdf_value(const Point3 &o, const Vec3 &v) const {
+  if (empty())
+    return 0.0f;
+
+  float u, w;
+  background->direction_to_uv(v, u, w);
+  float sin_theta = std::sin(math::TRACER_PI * w);
+  if (sin_theta <= 1e-6f)
+    return 0.0f;
+
+  int i = std::clamp(static_cast<int>(u * nu), 0, nu - 1);
+  int j = std::clamp(static_cast<int>(w * nv), 0, nv - 1);
+  // 格内 (u, v) 均匀分布；(u, v) 到方向的雅可比为 2 pi^2 sin(theta)
+  float pdf_uv = marginal.pmf(j) * conditional[j].pmf(i) *
+                 static_cast<float>(nu * nv);
+  return pdf_uv /
+         (2.0f * math::TRACER_PI * math::TRACER_PI * sin_theta);
+}
+
+Vec3 EnvironmentLight::random(const Point3 &o) const {
+  if (empty())
+    return o + Vec3(0.0f, 0.0f, ENVIRONMENT_LIGHT_FAR);
+
+  uint32_t j = marginal.sample(math::random_float());
+  uint32_t i = conditional[j].sample(math::random_float());
+  float u = (i + math::random_float()) / static_cast<float>(nu);
+  float w = (j + math::random_float()) / static_cast<float>(nv);
+  return o + ENVIRONMENT_LIGHT_FAR * background->uv_to_direction(u, w);
+}
+
+} // namespace geometry
+} // namespace tracer
@@ -159,8 +159,12 @@ Vec3 Heart::random(const Point3 &o) const {
   float y = sin(phi) * r;
 
   float radius = rho * 1.5f;
-  // 返回心形中心附近的表面点坐标
-  return center + radius * Vec3(x, y, z);
+  // 在包围球上取点，再沿 o 指向该点的方向求交得到心形表面上的点
+  Point3 target = center + radius * Vec3(x, y, z);
+  hit_record rec;
+  if (!this->hit(Ray(o, target - o), 0.001f, tracer::math::INF, rec))
+    return target;
+  return rec.p;
 }
 
 } // namespace geometry
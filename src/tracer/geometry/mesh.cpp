@@ -1,4 +1,8 @@
 #include "tracer/geometry/mesh.h"
+#include "tracer/geometry/mesh_cache.h"
+#include "tracer/geometry/mesh_light.h"
+#include <chrono>
+#include <limits>
 
 namespace tracer {
 namespace geometry {
@@ -82,18 +86,17 @@ private:
   void compute_bounds(uint32_t start, uint32_t end, AABB &bbox,
                       AABB &centroid_bbox) {
     uint32_t first_tri_idx = mesh.tri_indices[start];
-    const uint32_t *f_idx = &mesh.indices[first_tri_idx * 3];
+    Vec3 first = mesh.position(mesh.index_at(first_tri_idx * 3));
 
-    bbox = AABB(mesh.vertices[f_idx[0]].vertex, mesh.vertices[f_idx[0]].vertex);
+    bbox = AABB(first, first);
     centroid_bbox =
         AABB(tri_centroids[first_tri_idx], tri_centroids[first_tri_idx]);
 
     for (uint32_t i = start; i < end; ++i) {
       uint32_t tri_idx = mesh.tri_indices[i];
-      const uint32_t *idx = &mesh.indices[tri_idx * 3];
-      bbox.expand(mesh.vertices[idx[0]].vertex);
-      bbox.expand(mesh.vertices[idx[1]].vertex);
-      bbox.expand(mesh.vertices[idx[2]].vertex);
+      bbox.expand(mesh.position(mesh.index_at(tri_idx * 3)));
+      bbox.expand(mesh.position(mesh.index_at(tri_idx * 3 + 1)));
+      bbox.expand(mesh.position(mesh.index_at(tri_idx * 3 + 2)));
       centroid_bbox.expand(tri_centroids[tri_idx]);
     }
   }
@@ -113,12 +116,11 @@ private:
     // 1. 填桶
     for (uint32_t i = start; i < end; ++i) {
       uint32_t tri_idx = mesh.tri_indices[i];
-      const uint32_t *idx = &mesh.indices[tri_idx * 3];
+      Vec3 p0 = mesh.position(mesh.index_at(tri_idx * 3));
 
-      AABB tri_bounds(mesh.vertices[idx[0]].vertex,
-                      mesh.vertices[idx[0]].vertex);
-      tri_bounds.expand(mesh.vertices[idx[1]].vertex);
-      tri_bounds.expand(mesh.vertices[idx[2]].vertex);
+      AABB tri_bounds(p0, p0);
+      tri_bounds.expand(mesh.position(mesh.index_at(tri_idx * 3 + 1)));
+      tri_bounds.expand(mesh.position(mesh.index_at(tri_idx * 3 + 2)));
 
       float offset =
           (tri_centroids[tri_idx][axis] - min_centroid_axis) / max_axis_length;
@@ -228,18 +230,136 @@ private:
   }
 };
 
+// 4 路 SIMD Möller–Trumbore，一次测试一个 TriBlock4，
+// 返回 (t_min, t_max) 内命中通道的位掩码，各通道的 t/u/v 写入输出数组
+inline int intersect_block4(const TriBlock4 &b, const __m128 o[3],
+                            const __m128 d[3], float t_min, float t_max,
+                            float *t_out, float *u_out, float *v_out) {
+  const __m128 EPS = _mm_set1_ps(1e-9f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  __m128 e1x = _mm_load_ps(b.e1[0]), e1y = _mm_load_ps(b.e1[1]),
+         e1z = _mm_load_ps(b.e1[2]);
+  __m128 e2x = _mm_load_ps(b.e2[0]), e2y = _mm_load_ps(b.e2[1]),
+         e2z = _mm_load_ps(b.e2[2]);
+
+  // h = cross(d, e2), a = dot(e1, h)
+  __m128 hx = _mm_sub_ps(_mm_mul_ps(d[1], e2z), _mm_mul_ps(d[2], e2y));
+  __m128 hy = _mm_sub_ps(_mm_mul_ps(d[2], e2x), _mm_mul_ps(d[0], e2z));
+  __m128 hz = _mm_sub_ps(_mm_mul_ps(d[0], e2y), _mm_mul_ps(d[1], e2x));
+  __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)),
+                        _mm_mul_ps(e1z, hz));
+
+  // |a| > EPS，退化三角形（包括填充通道）在这里被剔除；
+  // a 的符号即朝向（a < 0 为背面），按通道的剔除标记直接丢弃
+  __m128 abs_a = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+  __m128 mask = _mm_cmpgt_ps(abs_a, EPS);
+  int back = _mm_movemask_ps(a);
+  int allowed = _mm_movemask_ps(mask) &
+                ~((back & b.cull_back) | (~back & b.cull_front));
+  if (allowed == 0)
+    return 0;
+
+  __m128 f = _mm_div_ps(one, _mm_blendv_ps(one, a, mask));
+
+  // s = o - v0, u = f * dot(s, h)
+  __m128 sx = _mm_sub_ps(o[0], _mm_load_ps(b.v0[0]));
+  __m128 sy = _mm_sub_ps(o[1], _mm_load_ps(b.v0[1]));
+  __m128 sz = _mm_sub_ps(o[2], _mm_load_ps(b.v0[2]));
+  __m128 u = _mm_mul_ps(
+      f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)),
+                    _mm_mul_ps(sz, hz)));
+  mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+  mask = _mm_and_ps(mask, _mm_cmple_ps(u, one));
+
+  // q = cross(s, e1), v = f * dot(d, q), t = f * dot(e2, q)
+  __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+  __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+  __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+  __m128 v = _mm_mul_ps(
+      f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], qx), _mm_mul_ps(d[1], qy)),
+                    _mm_mul_ps(d[2], qz)));
+  mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+  mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+
+  __m128 t = _mm_mul_ps(
+      f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)),
+                    _mm_mul_ps(e2z, qz)));
+  __m128 t_lo = _mm_set1_ps(std::max(t_min, 1e-9f));
+  mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, t_lo));
+  mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(t_max)));
+
+  int bits = _mm_movemask_ps(mask) & allowed;
+  if (bits != 0) {
+    _mm_store_ps(t_out, t);
+    _mm_store_ps(u_out, u);
+    _mm_store_ps(v_out, v);
+  }
+  return bits;
+}
+
+// 在命中掩码中选出 t 最小的通道
+inline int nearest_lane(const float *t, int bits) {
+  int lane = -1;
+  for (int i = 0; i < 4; ++i) {
+    if ((bits & (1 << i)) && (lane < 0 || t[i] < t[lane]))
+      lane = i;
+  }
+  return lane;
+}
+
+// 顶点到三角形的邻接表（CSR）：顶点 v 所在的三角形为
+// faces[offsets[v]] ~ faces[offsets[v + 1] - 1]，按三角形下标升序排列，
+// 逐顶点聚合时的求和顺序与逐三角形累加完全相同
+struct VertexFaces {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> faces;
+};
+
+VertexFaces build_vertex_faces(const std::vector<uint32_t> &indices,
+                               size_t vertex_count) {
+  const int64_t corners = static_cast<int64_t>(indices.size());
+  const int64_t vertex_total = static_cast<int64_t>(vertex_count);
+  VertexFaces adj;
+  adj.offsets.assign(vertex_count + 1, 0);
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < corners; ++i) {
+#pragma omp atomic
+    ++adj.offsets[indices[i] + 1];
+  }
+  for (size_t v = 0; v < vertex_count; ++v)
+    adj.offsets[v + 1] += adj.offsets[v];
+
+  std::vector<uint32_t> cursor(adj.offsets.begin(), adj.offsets.end() - 1);
+  adj.faces.resize(indices.size());
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < corners; ++i) {
+    uint32_t slot;
+#pragma omp atomic capture
+    slot = cursor[indices[i]]++;
+    adj.faces[slot] = static_cast<uint32_t>(i / 3);
+  }
+  // 原子计数打乱了写入顺序，逐顶点排序恢复升序
+#pragma omp parallel for schedule(dynamic, 4096)
+  for (int64_t v = 0; v < vertex_total; ++v)
+    std::sort(adj.faces.begin() + adj.offsets[v],
+              adj.faces.begin() + adj.offsets[v + 1]);
+  return adj;
+}
+
 } // namespace
 
 void Mesh::build_bvh() {
-  size_t n = indices.size() / 3;
+  size_t n = triangle_count();
   tri_indices.resize(n);
   std::iota(tri_indices.begin(), tri_indices.end(), 0);
 
   std::vector<Vec3> tri_centroids(n);
   for (size_t i = 0; i < n; ++i) {
-    const uint32_t *idx = &indices[i * 3];
-    tri_centroids[i] = (vertices[idx[0]].vertex + vertices[idx[1]].vertex +
-                        vertices[idx[2]].vertex) /
+    tri_centroids[i] = (position(index_at(i * 3)) +
+                        position(index_at(i * 3 + 1)) +
+                        position(index_at(i * 3 + 2))) /
                        3.0f;
   }
 
@@ -250,71 +370,175 @@ void Mesh::build_bvh() {
   BVHBuilder builder(*this, tri_centroids);
   builder.build_recursive(0, static_cast<uint32_t>(n), 0, node_count);
   nodes.resize(node_count);
+
+  build_tri_blocks();
 }
 
-bool Mesh::ray_triangle_intersect(const Ray &r, const Vec3 &v0, const Vec3 &v1,
-                                  const Vec3 &v2, float &t, float &u,
-                                  float &v) {
-  const float EPS = 1e-9f;
-  Vec3 e1 = v1 - v0;
-  Vec3 e2 = v2 - v0;
-  Vec3 h = cross(r.direction(), e2);
-  float a = dot(e1, h);
-  if (fabs(a) < EPS)
-    return false;
+void Mesh::build_tri_blocks() {
+  // 为每个叶子分配 ceil(count / 4) 个块，按叶子顺序把 v0/e1/e2 转置成 SoA，
+  // 遍历时顺序读取，不再经过 indices 间接寻址
+  uint32_t block_count = 0;
+  for (BVHNode &node : nodes) {
+    if (node.count > 0) {
+      node.block = block_count;
+      block_count += (node.count + 3) / 4;
+    }
+  }
+  tri_blocks.assign(block_count, TriBlock4{});
+
+  // 逐三角形的标记：剔除模式（材质优先于网格）；带 alpha 镂空的材质
+  // 检查三角形 UV 包围矩形，完全不透明的三角形不设置 alpha_mask，
+  // 求交时跳过纹理查询
+  for (const BVHNode &node : nodes) {
+    for (uint32_t k = 0; k < node.count; ++k) {
+      TriBlock4 &b = tri_blocks[node.block + k / 4];
+      uint8_t lane_bit = static_cast<uint8_t>(1 << (k % 4));
+      uint32_t tri = tri_indices[node.start + k];
+      int mat_idx = material_indices[tri];
+      const Material *mat = (mat_idx >= 0 && mat_idx < (int)materials.size())
+                                ? materials[mat_idx].get()
+                                : nullptr;
+
+      CullMode mode = (mat && mat->cull_mode != CullMode::Inherit)
+                          ? mat->cull_mode
+                          : cull_mode;
+      if (mode == CullMode::Back)
+        b.cull_back |= lane_bit;
+      else if (mode == CullMode::Front)
+        b.cull_front |= lane_bit;
+
+      if (!mat || !mat->has_alpha_cutout())
+        continue;
+
+      Vec2 uv0 = fetch_vertex(index_at(tri * 3)).tex_coord;
+      Vec2 uv1 = fetch_vertex(index_at(tri * 3 + 1)).tex_coord;
+      Vec2 uv2 = fetch_vertex(index_at(tri * 3 + 2)).tex_coord;
+      float u0 = std::min({uv0.x(), uv1.x(), uv2.x()});
+      float u1 = std::max({uv0.x(), uv1.x(), uv2.x()});
+      float v0 = std::min({uv0.y(), uv1.y(), uv2.y()});
+      float v1 = std::max({uv0.y(), uv1.y(), uv2.y()});
+      if (!mat->opaque_in_rect(u0, v0, u1, v1))
+        b.alpha_mask |= lane_bit;
+    }
+  }
 
-  float f = 1.0f / a;
-  Vec3 s = r.origin() - v0;
-  u = f * dot(s, h);
-  if (u < 0.0f || u > 1.0f)
-    return false;
+  update_tri_blocks();
+}
 
-  Vec3 q = cross(s, e1);
-  v = f * dot(r.direction(), q);
-  if (v < 0.0f || u + v > 1.0f)
-    return false;
+void Mesh::update_tri_blocks() {
+  for (const BVHNode &node : nodes) {
+    for (uint32_t k = 0; k < node.count; ++k) {
+      TriBlock4 &b = tri_blocks[node.block + k / 4];
+      uint32_t lane = k % 4;
+      uint32_t tri = tri_indices[node.start + k];
+
+      Vec3 v0 = position(index_at(tri * 3));
+      Vec3 e1 = position(index_at(tri * 3 + 1)) - v0;
+      Vec3 e2 = position(index_at(tri * 3 + 2)) - v0;
+      for (int a = 0; a < 3; ++a) {
+        b.v0[a][lane] = v0[a];
+        b.e1[a][lane] = e1[a];
+        b.e2[a][lane] = e2[a];
+      }
+    }
+  }
+}
 
-  t = f * dot(e2, q);
-  return t > EPS;
+bool Mesh::alpha_pass(uint32_t tri, float b1, float b2) const {
+  Vec2 uv0 = fetch_vertex(index_at(tri * 3)).tex_coord;
+  Vec2 uv1 = fetch_vertex(index_at(tri * 3 + 1)).tex_coord;
+  Vec2 uv2 = fetch_vertex(index_at(tri * 3 + 2)).tex_coord;
+  Vec2 uv = (1.0f - b1 - b2) * uv0 + b1 * uv1 + b2 * uv2;
+  return materials[material_indices[tri]]->alpha_test(uv.x(), uv.y());
+}
+
+Vertex Mesh::fetch_vertex(uint32_t i) const {
+  if (compact_vertices.empty())
+    return vertices[i];
+
+  const CompactVertex &c = compact_vertices[i];
+  Vertex out;
+  out.vertex = c.vertex;
+  out.normal = math::oct_decode(c.normal);
+  out.tangent = math::oct_decode_tangent(c.tangent, out.tangent_sign);
+  out.tex_coord = Vec2(math::half_to_float(c.tex_coord[0]),
+                       math::half_to_float(c.tex_coord[1]));
+  return out;
+}
+
+void Mesh::compact_storage() {
+  if (vertex_format == VertexFormat::Compact && !vertices.empty()) {
+    compact_vertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      const Vertex &v = vertices[i];
+      CompactVertex &c = compact_vertices[i];
+      c.vertex = v.vertex;
+      c.normal = math::oct_encode(v.normal);
+      c.tangent = math::oct_encode_tangent(v.tangent, v.tangent_sign);
+      c.tex_coord[0] = math::float_to_half(v.tex_coord.x());
+      c.tex_coord[1] = math::float_to_half(v.tex_coord.y());
+    }
+    std::vector<Vertex>().swap(vertices);
+  }
+
+  if (compact_indices && !indices.empty() && vertex_count() <= 65536) {
+    indices16.assign(indices.begin(), indices.end());
+    std::vector<uint32_t>().swap(indices);
+  }
 }
 
 bool Mesh::hit(const Ray &r, float t_min, float t_max, hit_record &rec) const {
   if (nodes.empty())
     return false;
-  // static std::atomic<long long> total_tri_tests{0};
-  // static std::atomic<long long> total_rays{0};
-  // total_rays++;
+  const Vec3 orig = r.origin();
+  const Vec3 dir = r.direction();
+  const __m128 o4[3] = {_mm_set1_ps(orig.x()), _mm_set1_ps(orig.y()),
+                        _mm_set1_ps(orig.z())};
+  const __m128 d4[3] = {_mm_set1_ps(dir.x()), _mm_set1_ps(dir.y()),
+                        _mm_set1_ps(dir.z())};
+
   uint32_t stack[64];
   uint32_t top = 0;
   stack[top++] = 0;
 
   bool hit_anything = false;
-  uint32_t best_tri_idx = 0;
+  uint32_t best_slot = 0; // 命中三角形在叶子顺序中的位置
   float best_u = 0.0f, best_v = 0.0f;
+  uint32_t bytes = 0;
 
   while (top > 0) {
     uint32_t idx = stack[--top];
     const auto &node = nodes[idx];
+    bytes += sizeof(BVHNode);
 
     if (!node.bbox.hit(r, t_min, t_max))
       continue;
 
-    if (node.count > 0) { // 叶子节点
-      // total_tri_tests += node.count;
-      for (uint32_t i = node.start; i < node.start + node.count; ++i) {
-        uint32_t tri_idx = tri_indices[i];
-        float t, u, v;
-        if (ray_triangle_intersect(r, vertices[indices[tri_idx * 3]].vertex,
-                                   vertices[indices[tri_idx * 3 + 1]].vertex,
-                                   vertices[indices[tri_idx * 3 + 2]].vertex, t,
-                                   u, v)) {
-          if (t > t_min && t < t_max) {
-            t_max = t;
-            hit_anything = true;
-            best_tri_idx = tri_idx;
-            best_u = u;
-            best_v = v;
+    if (node.count > 0) { // 叶子节点：只读取热数据流，每次测试 4 个三角形
+      uint32_t block_count = (node.count + 3) / 4;
+      bytes += block_count * sizeof(TriBlock4);
+      for (uint32_t b = 0; b < block_count; ++b) {
+        const TriBlock4 &block = tri_blocks[node.block + b];
+        alignas(16) float ts[4], us[4], vs[4];
+        int bits = intersect_block4(block, o4, d4, t_min, t_max, ts, us, vs);
+
+        // 从近到远检查命中通道，被 alpha 镂空的候选直接丢弃
+        while (bits != 0) {
+          int lane = nearest_lane(ts, bits);
+          uint32_t slot = node.start + b * 4 + lane;
+          if (block.alpha_mask & (1 << lane)) {
+            bytes += 3 * vertex_stride();
+            if (!alpha_pass(tri_indices[slot], us[lane], vs[lane])) {
+              bits &= ~(1 << lane);
+              continue;
+            }
           }
+          t_max = ts[lane];
+          hit_anything = true;
+          best_slot = slot;
+          best_u = us[lane];
+          best_v = vs[lane];
+          break;
         }
       }
     } else { // 内部节点：根据光线方向决定最优压栈顺序
@@ -328,20 +552,19 @@ bool Mesh::hit(const Ray &r, float t_min, float t_max, hit_record &rec) const {
       }
     }
   }
-  // if (total_rays % 100000 == 0) {
-  //   float avg = (float)total_tri_tests / total_rays;
-  //   printf("Avg tris per ray: %.1f\n", avg);
-  //   std::cout << "[Ray Debug] Origin: " << r.origin().x()
-  //             << " Dir: " << r.direction().x() << " SceneBounds: ["
-  //             << bbox.min.x() << ", " << bbox.max.x() << "]" << std::endl;
-  // }
   if (hit_anything) {
+    // 冷数据流：只为最终命中的三角形读取一次着色属性
+    uint32_t best_tri_idx = tri_indices[best_slot];
+    bytes += sizeof(uint32_t) * 2 + sizeof(float) +
+             3 * (indices16.empty() ? sizeof(uint32_t) : sizeof(uint16_t)) +
+             3 * vertex_stride();
+
     rec.t = t_max;
     rec.p = r.at(t_max);
 
-    const Vertex &v0 = vertices[indices[best_tri_idx * 3]];
-    const Vertex &v1 = vertices[indices[best_tri_idx * 3 + 1]];
-    const Vertex &v2 = vertices[indices[best_tri_idx * 3 + 2]];
+    Vertex v0 = fetch_vertex(index_at(best_tri_idx * 3));
+    Vertex v1 = fetch_vertex(index_at(best_tri_idx * 3 + 1));
+    Vertex v2 = fetch_vertex(index_at(best_tri_idx * 3 + 2));
 
     float w = 1.0f - best_u - best_v;
     rec.normal =
@@ -355,10 +578,15 @@ bool Mesh::hit(const Ray &r, float t_min, float t_max, hit_record &rec) const {
     rec.tangent =
         normalize(w * v0.tangent + best_u * v1.tangent + best_v * v2.tangent);
 
-    rec.bitangent = cross(rec.normal, rec.tangent);
+    float sign = w * v0.tangent_sign + best_u * v1.tangent_sign +
+                 best_v * v2.tangent_sign;
+    rec.bitangent =
+        (sign < 0.0f ? -1.0f : 1.0f) * cross(rec.normal, rec.tangent);
 
     rec.triangle_idx = best_tri_idx;
     rec.triangle_area = tri_area[best_tri_idx];
+    rec.uv_density = geometry::uv_density(v0, v1, v2);
+    rec.object = this;
 
     int mat_idx = material_indices[best_tri_idx];
     rec.mat_ptr = (mat_idx >= 0 && mat_idx < (int)materials.size())
@@ -369,6 +597,7 @@ bool Mesh::hit(const Ray &r, float t_min, float t_max, hit_record &rec) const {
     if (!rec.front_face)
       rec.normal = -rec.normal;
   }
+  r.bytes_touched += bytes;
 
   return hit_anything;
 }
@@ -385,15 +614,28 @@ float Mesh::pdf_value(const Vec3 &o, const Vec3 &v) const {
     return 0.0f;
   if (!rec.mat_ptr)
     return 0.0f;
+  return light_pdf(o, v, rec);
+}
 
-  float A = rec.triangle_area;
-  float cos_theta = fabs(dot(v, rec.normal));
+float Mesh::light_pdf(const Vec3 &o, const Vec3 &v,
+                      const hit_record &rec) const {
+  if (rec.object != this || total_area <= 0.0f)
+    return 0.0f;
 
+  float cos_theta =
+      std::fabs(dot(unit_vector(v), geometric_normal(rec.triangle_idx)));
   if (cos_theta < 1e-6f)
     return 0.0f;
 
-  float d2 = rec.t * rec.t;
-  return d2 / (A * cos_theta) * (1.0f / total_area);
+  float d2 = (rec.p - o).squared_length();
+  return d2 / (cos_theta * total_area);
+}
+
+std::shared_ptr<hittable> Mesh::light_source() const {
+  auto light = std::make_shared<MeshLight>(shared_from_this());
+  if (light->empty())
+    return nullptr;
+  return light;
 }
 
 Vec3 Mesh::random(const Vec3 &o) const {
@@ -404,9 +646,9 @@ Vec3 Mesh::random(const Vec3 &o) const {
   auto it = std::upper_bound(tri_cdf.begin(), tri_cdf.end(), r);
   uint32_t tri_idx = uint32_t(it - tri_cdf.begin() - 1);
 
-  const Vec3 &v0 = vertices[indices[tri_idx * 3]].vertex;
-  const Vec3 &v1 = vertices[indices[tri_idx * 3 + 1]].vertex;
-  const Vec3 &v2 = vertices[indices[tri_idx * 3 + 2]].vertex;
+  Vec3 v0 = position(index_at(tri_idx * 3));
+  Vec3 v1 = position(index_at(tri_idx * 3 + 1));
+  Vec3 v2 = position(index_at(tri_idx * 3 + 2));
 
   float r1 = math::random_float();
   float r2 = math::random_float();
@@ -419,37 +661,40 @@ Vec3 Mesh::random(const Vec3 &o) const {
 }
 
 void Mesh::compute_smooth_normals() {
-  for (size_t i = 0; i < indices.size(); i += 3) {
-    int i0 = indices[i];
-    int i1 = indices[i + 1];
-    int i2 = indices[i + 2];
-
-    Vec3 n = cross(vertices[i1].vertex - vertices[i0].vertex,
-                   vertices[i2].vertex - vertices[i0].vertex);
-    vertices[i0].normal += n;
-    vertices[i1].normal += n;
-    vertices[i2].normal += n;
+  // 先并行求出各三角形的面法线（未归一化，长度即面积权重），
+  // 再由每个顶点聚合所在三角形的面法线，没有写冲突
+  const int64_t tri_count = static_cast<int64_t>(indices.size() / 3);
+  const int64_t vertex_total = static_cast<int64_t>(vertices.size());
+  std::vector<Vec3> face_normals(tri_count);
+#pragma omp parallel for schedule(static)
+  for (int64_t t = 0; t < tri_count; ++t) {
+    const Vec3 &p0 = vertices[indices[3 * t]].vertex;
+    face_normals[t] = cross(vertices[indices[3 * t + 1]].vertex - p0,
+                            vertices[indices[3 * t + 2]].vertex - p0);
   }
 
-  for (Vertex &v : vertices) {
-    v.normal = (v.normal.squared_length() > 0.0f) ? normalize(v.normal)
-                                                  : Vec3(0.0f, 0.0f, 1.0f);
+  VertexFaces adj = build_vertex_faces(indices, vertices.size());
+#pragma omp parallel for schedule(static)
+  for (int64_t v = 0; v < vertex_total; ++v) {
+    Vec3 n = vertices[v].normal;
+    for (uint32_t k = adj.offsets[v]; k < adj.offsets[v + 1]; ++k)
+      n += face_normals[adj.faces[k]];
+    vertices[v].normal =
+        (n.squared_length() > 0.0f) ? normalize(n) : Vec3(0.0f, 0.0f, 1.0f);
   }
 }
 
 void Mesh::compute_tangents() {
-  // 为每个顶点初始化切线和副切线为零
-  std::vector<Vec3> tangents(vertices.size(), Vec3(0.0f, 0.0f, 0.0f));
-
-  // 遍历所有三角形
-  for (uint32_t tri = 0; tri < indices.size(); tri += 3) {
-    uint32_t idx0 = indices[tri];
-    uint32_t idx1 = indices[tri + 1];
-    uint32_t idx2 = indices[tri + 2];
-
-    const Vertex &v0 = vertices[idx0];
-    const Vertex &v1 = vertices[idx1];
-    const Vertex &v2 = vertices[idx2];
+  // 与平滑法线相同：并行求出每个三角形的切线和副切线，再逐顶点聚合
+  const int64_t tri_count = static_cast<int64_t>(indices.size() / 3);
+  const int64_t vertex_total = static_cast<int64_t>(vertices.size());
+  std::vector<Vec3> face_tangents(tri_count);
+  std::vector<Vec3> face_bitangents(tri_count);
+#pragma omp parallel for schedule(static)
+  for (int64_t t = 0; t < tri_count; ++t) {
+    const Vertex &v0 = vertices[indices[3 * t]];
+    const Vertex &v1 = vertices[indices[3 * t + 1]];
+    const Vertex &v2 = vertices[indices[3 * t + 2]];
 
     // 边向量
     Vec3 deltaPos1 = v1.vertex - v0.vertex;
@@ -461,74 +706,137 @@ void Mesh::compute_tangents() {
 
     float det = deltaUV1.x() * deltaUV2.y() - deltaUV1.y() * deltaUV2.x();
 
-    if (std::abs(det) < 1e-8f)
+    // UV 退化的三角形没有贡献
+    if (std::abs(det) < 1e-8f) {
+      face_tangents[t] = Vec3(0.0f, 0.0f, 0.0f);
+      face_bitangents[t] = Vec3(0.0f, 0.0f, 0.0f);
       continue;
+    }
 
     float r = 1.0f / det;
-    Vec3 tangent = (deltaPos1 * deltaUV2.y() - deltaPos2 * deltaUV1.y()) * r;
-
-    // 累加贡献到三个顶点
-    tangents[idx0] += tangent;
-    tangents[idx1] += tangent;
-    tangents[idx2] += tangent;
+    face_tangents[t] =
+        (deltaPos1 * deltaUV2.y() - deltaPos2 * deltaUV1.y()) * r;
+    face_bitangents[t] =
+        (deltaPos2 * deltaUV1.x() - deltaPos1 * deltaUV2.x()) * r;
   }
 
-  // 归一化并存储到 Vertex
-  for (size_t i = 0; i < vertices.size(); ++i) {
+  VertexFaces adj = build_vertex_faces(indices, vertices.size());
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < vertex_total; ++i) {
+    Vec3 t(0.0f, 0.0f, 0.0f);
+    Vec3 bitangent(0.0f, 0.0f, 0.0f);
+    for (uint32_t k = adj.offsets[i]; k < adj.offsets[i + 1]; ++k) {
+      t += face_tangents[adj.faces[k]];
+      bitangent += face_bitangents[adj.faces[k]];
+    }
+
     Vec3 n = vertices[i].normal;
-    Vec3 t = tangents[i];
     if (t.squared_length() < 1e-12f) {
       vertices[i].tangent = Vec3(1.0f, 0.0f, 0.0f); // 默认切线
     } else {
       // 重新正交化（Gram-Schmidt）以确保 tangent 垂直于 normal
       vertices[i].tangent = normalize(t - dot(t, n) * n);
     }
-    vertices[i].bitangent = normalize(cross(n, vertices[i].tangent));
+    // 副切线不再存储，只记录它相对 cross(n, t) 的手性（UV 镜像时为 -1）
+    vertices[i].tangent_sign =
+        dot(cross(n, vertices[i].tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
   }
 }
 
 void Mesh::build_area_cdf() {
-  uint32_t tri_count = (uint32_t)indices.size() / 3;
+  const int64_t tri_count = static_cast<int64_t>(indices.size() / 3);
   tri_area.resize(tri_count);
   tri_cdf.resize(tri_count + 1);
   tri_cdf[0] = 0.0f;
-  total_area = 0.0f;
-
-  for (uint32_t i = 0; i < tri_count; ++i) {
-    const Vec3 &v0 = vertices[indices[i * 3]].vertex;
-    const Vec3 &v1 = vertices[indices[i * 3 + 1]].vertex;
-    const Vec3 &v2 = vertices[indices[i * 3 + 2]].vertex;
-    float area = 0.5f * cross(v1 - v0, v2 - v0).length();
-    tri_area[i] = area;
-    total_area += area;
-    tri_cdf[i + 1] = total_area;
+
+  // 分块并行的前缀和：各块先求面积和块内的前缀和，块的起点由块总和的
+  // 前缀和得到，最后并行加上起点
+  const int64_t block = 1 << 16;
+  const int64_t blocks = (tri_count + block - 1) / block;
+  std::vector<float> block_sum(blocks + 1, 0.0f);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    float sum = 0.0f;
+    for (int64_t i = b * block; i < std::min(tri_count, (b + 1) * block);
+         ++i) {
+      const Vec3 &v0 = vertices[indices[i * 3]].vertex;
+      const Vec3 &v1 = vertices[indices[i * 3 + 1]].vertex;
+      const Vec3 &v2 = vertices[indices[i * 3 + 2]].vertex;
+      float area = 0.5f * cross(v1 - v0, v2 - v0).length();
+      tri_area[i] = area;
+      sum += area;
+      tri_cdf[i + 1] = sum;
+    }
+    block_sum[b + 1] = sum;
   }
+  for (int64_t b = 0; b < blocks; ++b)
+    block_sum[b + 1] += block_sum[b];
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 1; b < blocks; ++b) {
+    for (int64_t i = b * block; i < std::min(tri_count, (b + 1) * block); ++i)
+      tri_cdf[i + 1] += block_sum[b];
+  }
+  total_area = tri_cdf[tri_count];
 }
 
 void Mesh::finalize() {
+  finalize_times = FinalizeTimes();
   if (vertices.empty() || indices.empty())
     return;
+  if (cached) {
+    build_tri_blocks();
+    compact_storage();
+    return;
+  }
 
+  using clock = std::chrono::steady_clock;
+  auto seconds = [](clock::time_point &start) {
+    clock::time_point now = clock::now();
+    double elapsed = std::chrono::duration<double>(now - start).count();
+    start = now;
+    return elapsed;
+  };
+  clock::time_point start = clock::now();
+
+  // 包围盒与“是否全部缺少法线”在同一遍中并行归约
+  const int64_t vertex_total = static_cast<int64_t>(vertices.size());
   Vec3 min_p = vertices[0].vertex;
   Vec3 max_p = vertices[0].vertex;
-  for (const auto &v : vertices) {
-    min_p = Vec3::min(min_p, v.vertex);
-    max_p = Vec3::max(max_p, v.vertex);
-  }
-  bbox = AABB(min_p, max_p);
   bool need_smooth = true;
-  for (const auto &v : vertices) {
-    if (v.normal.squared_length() > 0.0f) {
-      need_smooth = false;
-      break;
+#pragma omp parallel
+  {
+    Vec3 local_min = min_p, local_max = max_p;
+    bool local_smooth = true;
+#pragma omp for schedule(static) nowait
+    for (int64_t i = 0; i < vertex_total; ++i) {
+      local_min = Vec3::min(local_min, vertices[i].vertex);
+      local_max = Vec3::max(local_max, vertices[i].vertex);
+      if (vertices[i].normal.squared_length() > 0.0f)
+        local_smooth = false;
+    }
+#pragma omp critical
+    {
+      min_p = Vec3::min(min_p, local_min);
+      max_p = Vec3::max(max_p, local_max);
+      need_smooth = need_smooth && local_smooth;
     }
   }
+  bbox = AABB(min_p, max_p);
+  finalize_times.bounds = seconds(start);
+
   if (need_smooth) {
     compute_smooth_normals();
   }
+  finalize_times.normals = seconds(start);
   compute_tangents();
+  finalize_times.tangents = seconds(start);
   build_area_cdf();
+  finalize_times.area_cdf = seconds(start);
   build_bvh();
+  finalize_times.bvh = seconds(start);
+  if (cache_key != 0)
+    MeshCache::instance().store(cache_key, *this);
+  compact_storage();
 }
 
 void Mesh::refit_bvh() {
@@ -540,14 +848,14 @@ void Mesh::refit_bvh() {
 void Mesh::refit_recursive(uint32_t node_idx) {
   BVHNode &node = nodes[node_idx];
   if (node.count > 0) {
-    uint32_t f0 = indices[tri_indices[node.start] * 3];
-    AABB box(vertices[f0].vertex, vertices[f0].vertex);
+    Vec3 p0 = position(index_at(tri_indices[node.start] * 3));
+    AABB box(p0, p0);
 
     for (uint32_t i = node.start; i < node.start + node.count; ++i) {
       uint32_t tri_idx = tri_indices[i];
-      box.expand(vertices[indices[tri_idx * 3]].vertex);
-      box.expand(vertices[indices[tri_idx * 3 + 1]].vertex);
-      box.expand(vertices[indices[tri_idx * 3 + 2]].vertex);
+      box.expand(position(index_at(tri_idx * 3)));
+      box.expand(position(index_at(tri_idx * 3 + 1)));
+      box.expand(position(index_at(tri_idx * 3 + 2)));
     }
     node.bbox = box;
   } else {
@@ -561,9 +869,38 @@ void Mesh::refit_recursive(uint32_t node_idx) {
 void Mesh::refit_blas() {
   if (!nodes.empty()) {
     refit_bvh();
+    update_tri_blocks();
     bbox = nodes[0].bbox;
   }
 }
 
+void Mesh::print_memory_stats() const {
+  bool compact = !compact_vertices.empty();
+  size_t vertex_bytes = vertices.size() * sizeof(Vertex) +
+                        compact_vertices.size() * sizeof(CompactVertex);
+  size_t index_bytes =
+      indices.size() * sizeof(uint32_t) + indices16.size() * sizeof(uint16_t);
+  size_t hot = nodes.size() * sizeof(BVHNode) +
+               tri_blocks.size() * sizeof(TriBlock4);
+  size_t cold = vertex_bytes + index_bytes +
+                tri_indices.size() * sizeof(uint32_t) +
+                material_indices.size() * sizeof(uint32_t) +
+                (tri_area.size() + tri_cdf.size()) * sizeof(float);
+
+  std::cout << "网格内存: " << triangle_count() << " 个三角形, "
+            << vertex_count() << " 个顶点" << std::endl;
+  std::cout << "  热数据（BVH 节点 + 求交三角形）: " << hot / 1024.0 << " KB ("
+            << sizeof(BVHNode) << " B/节点, " << sizeof(TriBlock4)
+            << " B/4 个三角形)" << std::endl;
+  std::cout << "  冷数据（顶点属性 + 索引 + 面积表）: " << cold / 1024.0
+            << " KB" << std::endl;
+  std::cout << "    顶点: " << vertex_bytes / 1024.0 << " KB ("
+            << (compact ? "压缩格式, " : "完整格式, ")
+            << (compact ? sizeof(CompactVertex) : sizeof(Vertex))
+            << " B/顶点)" << std::endl;
+  std::cout << "    索引: " << index_bytes / 1024.0 << " KB ("
+            << (indices16.empty() ? 32 : 16) << " 位)" << std::endl;
+}
+
 } // namespace geometry
 } // namespace tracer
\ No newline at end of file
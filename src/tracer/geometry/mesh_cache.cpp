@@ -0,0 +1,270 @@
+#include "tracer/geometry/mesh_cache.h"
+#include "tracer/utils/cache_dir.h"
+#include "tracer/utils/content_hash.h"
+#include "tracer/utils/mapped_file.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace tracer {
+namespace geometry {
+
+namespace fs = std::filesystem;
+
+// 格式或 BVH 构建方式改变时加一，旧的缓存文件随之失效
+static constexpr uint32_t MESH_CACHE_VERSION = 1;
+static constexpr size_t SECTION_ALIGN = 64;
+
+static_assert(std::is_trivially_copyable<Vertex>::value &&
+                  std::is_trivially_copyable<Mesh::BVHNode>::value,
+              "网格缓存按字节拷贝顶点和 BVH 节点");
+
+// 文件头之后依次为 vertices、indices、material_indices、tri_area、
+// tri_cdf、nodes、tri_indices，每段从 64 字节对齐的偏移开始
+struct MeshCacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint64_t counts[7];
+  float bounds[6];
+  float total_area;
+  uint32_t reserved;
+};
+
+#ifdef _WIN32
+static int process_id() { return _getpid(); }
+#else
+static int process_id() { return static_cast<int>(::getpid()); }
+#endif
+
+template <class T>
+static void write_section(std::ofstream &out, const T *data, size_t count) {
+  static const char zeros[SECTION_ALIGN] = {};
+  const size_t bytes = count * sizeof(T);
+  out.write(reinterpret_cast<const char *>(data), bytes);
+  out.write(zeros, (SECTION_ALIGN - bytes % SECTION_ALIGN) % SECTION_ALIGN);
+}
+
+static size_t section_bytes(uint64_t count, size_t size) {
+  return (count * size + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+static size_t header_bytes() {
+  return section_bytes(1, sizeof(MeshCacheHeader));
+}
+
+template <class T>
+static void read_section(const char *&p, std::vector<T> &out, uint64_t count) {
+  out.resize(count);
+  std::memcpy(out.data(), p, count * sizeof(T));
+  p += section_bytes(count, sizeof(T));
+}
+
+// 各段数量之间的关系：每个三角形 3 个索引、1 个材质下标、1 个面积，
+// 累积面积多 1 个；BVH 至少 1 个节点，最多 2 * 三角形数 - 1 个
+static bool valid_counts(const uint64_t counts[7]) {
+  const uint64_t tris = counts[2];
+  return tris > 0 && counts[0] > 0 &&
+         counts[0] <= std::numeric_limits<uint32_t>::max() &&
+         counts[1] == 3 * tris && counts[3] == tris &&
+         counts[4] == tris + 1 && counts[6] == tris && counts[5] > 0 &&
+         counts[5] < 2 * tris;
+}
+
+// 检查所有会被当作下标使用的数据，缓存文件可能是旧的、损坏的或者
+// 被别人放进来的，越界的下标会在求交和生成 TriBlock4 时越界读取
+static bool valid_geometry(const Mesh &m, uint32_t material_count) {
+  const size_t vertex_count = m.vertices.size();
+  const size_t tri_count = m.material_indices.size();
+  for (uint32_t index : m.indices) {
+    if (index >= vertex_count)
+      return false;
+  }
+  for (uint32_t material : m.material_indices) {
+    if (material >= material_count)
+      return false;
+  }
+  for (uint32_t tri : m.tri_indices) {
+    if (tri >= tri_count)
+      return false;
+  }
+  // 构建时节点按先序编号，子节点的下标总是大于父节点，据此排除环
+  const size_t node_count = m.nodes.size();
+  for (size_t i = 0; i < node_count; ++i) {
+    const Mesh::BVHNode &node = m.nodes[i];
+    if (node.count > 0) {
+      if (uint64_t(node.start) + node.count > m.tri_indices.size())
+        return false;
+    } else if (node.left <= i || node.right <= i ||
+               node.left >= node_count || node.right >= node_count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+MeshCache &MeshCache::instance() {
+  static MeshCache cache;
+  return cache;
+}
+
+MeshCache::MeshCache() : dir(utils::user_cache_dir("meshes")) {}
+
+void MeshCache::set_directory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(mutex);
+  dir = directory;
+}
+
+bool MeshCache::enabled() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return !dir.empty();
+}
+
+std::string MeshCache::path(uint64_t key) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (dir.empty())
+    return "";
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.rmc",
+           static_cast<unsigned long long>(key));
+  return (fs::path(dir) / name).string();
+}
+
+uint64_t MeshCache::key(uint64_t seed) {
+  const uint64_t layout[4] = {MESH_CACHE_VERSION, sizeof(Vertex),
+                              sizeof(Mesh::BVHNode), sizeof(MeshCacheHeader)};
+  return utils::content_hash(layout, sizeof(layout), seed);
+}
+
+bool MeshCache::load(uint64_t key, uint32_t material_count,
+                     Mesh &mesh) const {
+  const std::string file = path(key);
+  if (file.empty())
+    return false;
+  utils::MappedFile mapped(file);
+  if (mapped.size() < header_bytes())
+    return false;
+
+  MeshCacheHeader header;
+  std::memcpy(&header, mapped.data(), sizeof(header));
+  if (std::memcmp(header.magic, "RTMC", 4) != 0 ||
+      header.version != MESH_CACHE_VERSION || header.key != key)
+    return false;
+
+  const size_t sizes[7] = {sizeof(Vertex),   sizeof(uint32_t),
+                           sizeof(uint32_t), sizeof(float),
+                           sizeof(float),    sizeof(Mesh::BVHNode),
+                           sizeof(uint32_t)};
+  // 先用文件大小限制每段的数量，之后的乘法和累加不会溢出
+  size_t expected = header_bytes();
+  bool fits = true;
+  for (int i = 0; i < 7 && fits; ++i) {
+    fits = header.counts[i] <= mapped.size() / sizes[i];
+    if (fits)
+      expected += section_bytes(header.counts[i], sizes[i]);
+  }
+  if (!fits || !valid_counts(header.counts) || mapped.size() != expected) {
+    std::cerr << "网格缓存文件不完整，重新构建: " << file << std::endl;
+    return false;
+  }
+
+  // 先读到临时的网格里，校验通过后再交给调用方
+  Mesh loaded;
+  const char *p = mapped.data() + header_bytes();
+  read_section(p, loaded.vertices, header.counts[0]);
+  read_section(p, loaded.indices, header.counts[1]);
+  read_section(p, loaded.material_indices, header.counts[2]);
+  read_section(p, loaded.tri_area, header.counts[3]);
+  read_section(p, loaded.tri_cdf, header.counts[4]);
+  read_section(p, loaded.nodes, header.counts[5]);
+  read_section(p, loaded.tri_indices, header.counts[6]);
+  if (!valid_geometry(loaded, material_count)) {
+    std::cerr << "网格缓存文件中的下标越界，重新构建: " << file << std::endl;
+    return false;
+  }
+
+  mesh.vertices = std::move(loaded.vertices);
+  mesh.indices = std::move(loaded.indices);
+  mesh.material_indices = std::move(loaded.material_indices);
+  mesh.tri_area = std::move(loaded.tri_area);
+  mesh.tri_cdf = std::move(loaded.tri_cdf);
+  mesh.nodes = std::move(loaded.nodes);
+  mesh.tri_indices = std::move(loaded.tri_indices);
+  mesh.bbox = AABB(Vec3(header.bounds[0], header.bounds[1], header.bounds[2]),
+                   Vec3(header.bounds[3], header.bounds[4], header.bounds[5]));
+  mesh.total_area = header.total_area;
+  mesh.cached = true;
+  std::cout << "已从网格缓存加载: " << file << " ("
+            << mapped.size() / (1024.0 * 1024.0) << " MB)" << std::endl;
+  return true;
+}
+
+// 先写临时文件再改名，多个进程同时写同一个模型时不会读到写了一半的文件
+void MeshCache::store(uint64_t key, const Mesh &mesh) const {
+  const std::string file = path(key);
+  if (file.empty())
+    return;
+  std::error_code ec;
+  fs::create_directories(fs::path(file).parent_path(), ec);
+
+  // 同一进程中内容相同的两个模型可能同时写同一个文件，临时文件名再加序号
+  static std::atomic<int> serial{0};
+  const std::string temp = file + ".tmp" + std::to_string(process_id()) +
+                           "_" + std::to_string(serial++);
+  {
+    std::ofstream out(temp, std::ios::binary);
+    if (!out)
+      return;
+
+    MeshCacheHeader header = {};
+    std::memcpy(header.magic, "RTMC", 4);
+    header.version = MESH_CACHE_VERSION;
+    header.key = key;
+    header.counts[0] = mesh.vertices.size();
+    header.counts[1] = mesh.indices.size();
+    header.counts[2] = mesh.material_indices.size();
+    header.counts[3] = mesh.tri_area.size();
+    header.counts[4] = mesh.tri_cdf.size();
+    header.counts[5] = mesh.nodes.size();
+    header.counts[6] = mesh.tri_indices.size();
+    for (int a = 0; a < 3; ++a) {
+      header.bounds[a] = mesh.bbox.min[a];
+      header.bounds[3 + a] = mesh.bbox.max[a];
+    }
+    header.total_area = mesh.total_area;
+    write_section(out, &header, 1);
+
+    write_section(out, mesh.vertices.data(), mesh.vertices.size());
+    write_section(out, mesh.indices.data(), mesh.indices.size());
+    write_section(out, mesh.material_indices.data(),
+                  mesh.material_indices.size());
+    write_section(out, mesh.tri_area.data(), mesh.tri_area.size());
+    write_section(out, mesh.tri_cdf.data(), mesh.tri_cdf.size());
+    write_section(out, mesh.nodes.data(), mesh.nodes.size());
+    write_section(out, mesh.tri_indices.data(), mesh.tri_indices.size());
+    if (!out) {
+      out.close();
+      fs::remove(temp, ec);
+      return;
+    }
+  }
+
+  fs::rename(temp, file, ec);
+  if (ec) {
+    fs::remove(temp, ec);
+    return;
+  }
+  std::cout << "已写入网格缓存: " << file << std::endl;
+}
+
+} // namespace geometry
+} // namespace tracer
@@ -0,0 +1,180 @@
+#include "tracer/geometry/mesh_light.h"
+
+namespace tracer {
+namespace geometry {
+
+MeshLight::MeshLight(std::shared_ptr<const Mesh> m) : mesh(std::move(m)) {
+  const size_t tri_count = mesh->triangle_count();
+  if (mesh->tri_area.size() != tri_count) {
+    std::cerr << "MeshLight: 网格尚未 finalize，忽略其自发光。" << std::endl;
+    return;
+  }
+  light_index.assign(tri_count, NOT_EMISSIVE);
+
+  // 每个三角形取 3 个顶点、3 个边中点和重心共 7 个点估计平均自发光
+  static const float bary[7][3] = {
+      {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+      {0.5f, 0.5f, 0.0f}, {0.0f, 0.5f, 0.5f}, {0.5f, 0.0f, 0.5f},
+      {1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f}};
+
+  std::vector<float> weights;
+  Vec3 normal_sum(0.0f, 0.0f, 0.0f);
+  int sides = 0; // 1：只有正面可见，-1：只有背面可见，0：双面
+  bool first = true;
+
+  for (uint32_t tri = 0; tri < tri_count; ++tri) {
+    int mat_idx = mesh->material_indices[tri];
+    if (mat_idx < 0 || mat_idx >= (int)mesh->materials.size())
+      continue;
+    const auto &mat = mesh->materials[mat_idx];
+    if (!mat)
+      continue;
+
+    Vertex v0 = mesh->fetch_vertex(mesh->index_at(tri * 3));
+    Vertex v1 = mesh->fetch_vertex(mesh->index_at(tri * 3 + 1));
+    Vertex v2 = mesh->fetch_vertex(mesh->index_at(tri * 3 + 2));
+    Vec3 n = mesh->geometric_normal(tri);
+
+    float luminance = 0.0f;
+    for (const auto &b : bary) {
+      hit_record rec;
+      rec.p = b[0] * v0.vertex + b[1] * v1.vertex + b[2] * v2.vertex;
+      Vec2 uv = b[0] * v0.tex_coord + b[1] * v1.tex_coord + b[2] * v2.tex_coord;
+      rec.u = uv.x();
+      rec.v = uv.y();
+      rec.normal = n;
+      rec.front_face = true;
+      rec.triangle_idx = tri;
+      rec.object = mesh.get();
+      Color e = mat->emitted(Ray(rec.p + n, -n), rec, rec.u, rec.v, rec.p);
+      luminance += 0.2126f * e.r() + 0.7152f * e.g() + 0.0722f * e.b();
+    }
+    luminance /= 7.0f;
+
+    float area = mesh->tri_area[tri];
+    if (luminance <= 0.0f || area <= 0.0f)
+      continue;
+
+    light_index[tri] = static_cast<uint32_t>(emissive.size());
+    emissive.push_back(tri);
+    weights.push_back(luminance * area);
+    power += luminance * area;
+
+    // 背面被剔除的三角形只向法线一侧发光
+    CullMode cull =
+        mat->cull_mode != CullMode::Inherit ? mat->cull_mode : mesh->cull_mode;
+    int side = cull == CullMode::Back ? 1 : cull == CullMode::Front ? -1 : 0;
+    if (first) {
+      sides = side;
+      bbox = AABB(v0.vertex, v0.vertex);
+      first = false;
+    } else if (side != sides) {
+      sides = 0;
+    }
+    normal_sum += static_cast<float>(side) * area * n;
+    bbox.expand(v0.vertex);
+    bbox.expand(v1.vertex);
+    bbox.expand(v2.vertex);
+  }
+
+  if (emissive.empty())
+    return;
+
+  table = math::AliasTable(weights);
+
+  if (sides != 0 && normal_sum.squared_length() > 0.0f) {
+    cone_axis = normalize(normal_sum);
+    cone_cos = 1.0f;
+    for (uint32_t tri : emissive)
+      cone_cos = std::min(cone_cos, static_cast<float>(sides) *
+                                        dot(cone_axis,
+                                            mesh->geometric_normal(tri)));
+    one_sided = cone_cos > -1.0f;
+  }
+
+  std::cout << "网格光源: " << emissive.size() << " 个自发光三角形" << std::endl;
+}
+
+bool MeshLight::hit(const Ray &r, float t_min, float t_max,
+                    hit_record &rec) const {
+  return mesh->hit(r, t_min, t_max, rec);
+}
+
+bool MeshLight::bounding_box(float t0, float t1, AABB &output_box) const {
+  if (emissive.empty())
+    return false;
+  output_box = bbox;
+  return true;
+}
+
+bool MeshLight::emission_cone(Vec3 &axis, float &cos_theta_o) const {
+  if (!one_sided)
+    return false;
+  axis = cone_axis;
+  cos_theta_o = cone_cos;
+  return true;
+}
+
+float MeshLight::light_pdf(const Point3 &o, const Vec3 &v,
+                           const hit_record &rec) const {
+  if (rec.object != mesh.get() || rec.triangle_idx >= light_index.size())
+    return 0.0f;
+  uint32_t k = light_index[rec.triangle_idx];
+  if (k == NOT_EMISSIVE)
+    return 0.0f;
+
+  float cos_theta =
+      std::fabs(dot(unit_vector(v), mesh->geometric_normal(rec.triangle_idx)));
+  if (cos_theta < 1e-6f)
+    return 0.0f;
+
+  float d2 = (rec.p - o).squared_length();
+  return table.pmf(k) * d2 / (cos_theta * mesh->tri_area[rec.triangle_idx]);
+}
+
+float MeshLight::pdf_value(const Point3 &o, const Vec3 &v) const {
+  hit_record rec;
+  if (emissive.empty() || !mesh->hit(Ray(o, v), 0.001f, math::INF, rec))
+    return 0.0f;
+  return light_pdf(o, v, rec);
+}
+
+Vec3 MeshLight::random(const Point3 &o) const {
+  if (emissive.empty())
+    return Vec3(0.0f, 0.0f, 0.0f);
+
+  uint32_t tri = emissive[table.sample(math::random_float())];
+  Vec3 v0 = mesh->position(mesh->index_at(tri * 3));
+  Vec3 v1 = mesh->position(mesh->index_at(tri * 3 + 1));
+  Vec3 v2 = mesh->position(mesh->index_at(tri * 3 + 2));
+
+  Vec3 b = math::random_triangle_barycentric();
+  return b.x() * v0 + b.y() * v1 + b.z() * v2;
+}
+
+float MeshLight::sample_surface(hit_record &rec) const {
+  if (emissive.empty())
+    return 0.0f;
+
+  uint32_t k = table.sample(math::random_float());
+  uint32_t tri = emissive[k];
+  Vertex v0 = mesh->fetch_vertex(mesh->index_at(tri * 3));
+  Vertex v1 = mesh->fetch_vertex(mesh->index_at(tri * 3 + 1));
+  Vertex v2 = mesh->fetch_vertex(mesh->index_at(tri * 3 + 2));
+
+  Vec3 b = math::random_triangle_barycentric();
+  rec.p = b.x() * v0.vertex + b.y() * v1.vertex + b.z() * v2.vertex;
+  Vec2 uv = b.x() * v0.tex_coord + b.y() * v1.tex_coord + b.z() * v2.tex_coord;
+  rec.u = uv.x();
+  rec.v = uv.y();
+  rec.normal = mesh->geometric_normal(tri);
+  rec.front_face = true;
+  rec.triangle_idx = tri;
+  rec.triangle_area = mesh->tri_area[tri];
+  rec.object = mesh.get();
+  rec.mat_ptr = mesh->materials[mesh->material_indices[tri]];
+  return table.pmf(k) / mesh->tri_area[tri];
+}
+
+} // namespace geometry
+} // namespace tracer
@@ -28,6 +28,9 @@ bool Sphere::hit(const Ray &r, float t_min, float t_max,
     }
     rec.t = t;
     rec.p = r.at(t);
+    // 单位 UV 正方形覆盖整个球面 4 pi r^2
+    rec.uv_density =
+        0.5f / (std::fabs(radius) * std::sqrt(tracer::math::TRACER_PI));
     auto normal = (rec.p - center) / radius;
     rec.set_face_normal(r, normal);
     get_sphere_uv(normal, rec.u, rec.v);
@@ -53,28 +56,50 @@ bool Sphere::bounding_box(float t0, float t1, AABB &output_box) const {
   return true;
 }
 
+// 从 o 点看球体张成的圆锥内均匀采样方向。
+// 按球面面积均匀采样时背面的点同样会被选中，而 pdf_value 只统计了
+// 最近交点，两者不一致会让球形光源的直接光照偏亮
 float Sphere::pdf_value(const Point3 &o, const Vec3 &v) const {
   hit_record rec;
   if (!this->hit(Ray(o, v), 0.001f, tracer::math::INF, rec))
     return 0.0f;
 
-  float A = 4.0f * tracer::math::TRACER_PI * radius * radius;
-  float d2 = rec.t * rec.t;
-  float cos_theta = fabs(dot(v, rec.normal));
-  return d2 / (cos_theta * A);
+  float d2 = (center - o).squared_length();
+  if (d2 <= radius * radius)
+    return 1.0f / (4.0f * tracer::math::TRACER_PI);
+
+  float cos_theta_max = std::sqrt(1.0f - radius * radius / d2);
+  float solid_angle = 2.0f * tracer::math::TRACER_PI * (1.0f - cos_theta_max);
+  return 1.0f / solid_angle;
 }
 
 Vec3 Sphere::random(const Point3 &o) const {
-  float r1 = math::random_float();
-  float r2 = math::random_float();
+  Vec3 direction = center - o;
+  float d2 = direction.squared_length();
+  Vec3 dir;
+  if (d2 <= radius * radius) {
+    dir = math::random_unit_vector();
+  } else {
+    onb uvw;
+    uvw.build_from_w(direction);
+    dir = uvw.local(math::random_to_sphere(radius, d2));
+  }
 
-  float z = 1.0f - 2.0f * r1;
-  float phi = 2.0f * math::TRACER_PI * r2;
-  float x = cos(phi) * sqrt(1.0f - z * z);
-  float y = sin(phi) * sqrt(1.0f - z * z);
+  // 返回方向上最近的球面点，直接光照据此判断采样点是否被遮挡
+  hit_record rec;
+  if (!this->hit(Ray(o, dir), 0.001f, tracer::math::INF, rec))
+    return o + dir * std::sqrt(d2);
+  return rec.p;
+}
 
-  Vec3 point_on_sphere = center + radius * Vec3(x, y, z);
-  return point_on_sphere;
+float Sphere::sample_surface(hit_record &rec) const {
+  Vec3 normal = math::random_unit_vector();
+  rec.p = center + radius * normal;
+  rec.normal = normal;
+  rec.front_face = true;
+  get_sphere_uv(normal, rec.u, rec.v);
+  rec.mat_ptr = mat_ptr;
+  return 1.0f / (4.0f * tracer::math::TRACER_PI * radius * radius);
 }
 
 } // namespace geometry
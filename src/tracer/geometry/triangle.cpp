@@ -10,13 +10,13 @@ std::shared_ptr<Material> Triangle::get_material() const {
 
 bool Triangle::hit(const Ray &r, float t_min, float t_max,
                    hit_record &rec) const {
-  uint32_t i0 = mesh_ptr->indices[index * 3];
-  uint32_t i1 = mesh_ptr->indices[index * 3 + 1];
-  uint32_t i2 = mesh_ptr->indices[index * 3 + 2];
+  uint32_t i0 = mesh_ptr->index_at(index * 3);
+  uint32_t i1 = mesh_ptr->index_at(index * 3 + 1);
+  uint32_t i2 = mesh_ptr->index_at(index * 3 + 2);
 
-  const Vec3 &v0 = mesh_ptr->vertices[i0].vertex;
-  const Vec3 &v1 = mesh_ptr->vertices[i1].vertex;
-  const Vec3 &v2 = mesh_ptr->vertices[i2].vertex;
+  Vec3 v0 = mesh_ptr->position(i0);
+  Vec3 v1 = mesh_ptr->position(i1);
+  Vec3 v2 = mesh_ptr->position(i2);
 
   // Möller-Trumbore
   Vec3 e1 = v1 - v0;
@@ -27,6 +27,16 @@ bool Triangle::hit(const Ray &r, float t_min, float t_max,
   if (fabs(det) < 1e-8)
     return false;
 
+  // 背面剔除：det < 0 为背面（与 Mesh 的叶子求交一致）
+  int mat_idx = mesh_ptr->material_indices[index];
+  const auto &mat = mesh_ptr->materials[mat_idx];
+  CullMode mode = (mat && mat->cull_mode != CullMode::Inherit)
+                      ? mat->cull_mode
+                      : mesh_ptr->cull_mode;
+  if ((mode == CullMode::Back && det < 0.0f) ||
+      (mode == CullMode::Front && det > 0.0f))
+    return false;
+
   float inv_det = 1.0f / det;
   Vec3 tvec = r.origin() - v0;
   float u = dot(tvec, pvec) * inv_det;
@@ -45,40 +55,43 @@ bool Triangle::hit(const Ray &r, float t_min, float t_max,
   if (t < t_min || t > t_max)
     return false;
 
+  // alpha 镂空：被镂空的命中直接丢弃，让光线继续穿过
+  if (mat && mat->has_alpha_cutout()) {
+    float w_cut = 1.0f - u - v;
+    Vec2 uv = w_cut * mesh_ptr->fetch_vertex(i0).tex_coord +
+              u * mesh_ptr->fetch_vertex(i1).tex_coord +
+              v * mesh_ptr->fetch_vertex(i2).tex_coord;
+    if (!mat->alpha_test(uv.x(), uv.y()))
+      return false;
+  }
+
   rec.t = t;
   rec.p = r.at(t);
 
-  int mat_idx = mesh_ptr->material_indices[index];
-  rec.mat_ptr = mesh_ptr->materials[mat_idx];
+  rec.mat_ptr = mat;
 
   float w = 1.0f - u - v;
 
-  const Vec3 &n0 = mesh_ptr->vertices[i0].normal;
-  const Vec3 &n1 = mesh_ptr->vertices[i1].normal;
-  const Vec3 &n2 = mesh_ptr->vertices[i2].normal;
-  rec.normal = unit_vector(w * n0 + u * n1 + v * n2);
+  Vertex a0 = mesh_ptr->fetch_vertex(i0);
+  Vertex a1 = mesh_ptr->fetch_vertex(i1);
+  Vertex a2 = mesh_ptr->fetch_vertex(i2);
+  rec.normal = unit_vector(w * a0.normal + u * a1.normal + v * a2.normal);
 
-  Vec2 uv0 = mesh_ptr->vertices[i0].tex_coord;
-  Vec2 uv1 = mesh_ptr->vertices[i1].tex_coord;
-  Vec2 uv2 = mesh_ptr->vertices[i2].tex_coord;
-  rec.u = uv0.x() * w + uv1.x() * u + uv2.x() * v;
-  rec.v = uv0.y() * w + uv1.y() * u + uv2.y() * v;
+  rec.u = a0.tex_coord.x() * w + a1.tex_coord.x() * u + a2.tex_coord.x() * v;
+  rec.v = a0.tex_coord.y() * w + a1.tex_coord.y() * u + a2.tex_coord.y() * v;
+  rec.uv_density = uv_density(a0, a1, a2);
 
   // 切线空间插值
-  const Vec3 &tangent0 = mesh_ptr->vertices[i0].tangent;
-  const Vec3 &tangent1 = mesh_ptr->vertices[i1].tangent;
-  const Vec3 &tangent2 = mesh_ptr->vertices[i2].tangent;
-  rec.tangent = unit_vector(w * tangent0 + u * tangent1 + v * tangent2);
-
-  const Vec3 &bitangent0 = mesh_ptr->vertices[i0].bitangent;
-  const Vec3 &bitangent1 = mesh_ptr->vertices[i1].bitangent;
-  const Vec3 &bitangent2 = mesh_ptr->vertices[i2].bitangent;
-  rec.bitangent = unit_vector(w * bitangent0 + u * bitangent1 + v * bitangent2);
+  rec.tangent = unit_vector(w * a0.tangent + u * a1.tangent + v * a2.tangent);
 
   // Gram-Schmidt 正交化，确保 tangent 垂直于法线
   rec.tangent =
       normalize(rec.tangent - dot(rec.tangent, rec.normal) * rec.normal);
-  rec.bitangent = cross(rec.normal, rec.tangent); // 重新计算副切线确保右手系
+  // 副切线由法线、切线和手性符号重建
+  float sign =
+      w * a0.tangent_sign + u * a1.tangent_sign + v * a2.tangent_sign;
+  rec.bitangent =
+      (sign < 0.0f ? -1.0f : 1.0f) * cross(rec.normal, rec.tangent);
 
   // 确保法线始终与射线方向相对
   rec.set_face_normal(r, rec.normal);
@@ -87,13 +100,13 @@ bool Triangle::hit(const Ray &r, float t_min, float t_max,
 }
 
 bool Triangle::bounding_box(float time0, float time1, AABB &output_box) const {
-  uint32_t i0 = mesh_ptr->indices[index * 3];
-  uint32_t i1 = mesh_ptr->indices[index * 3 + 1];
-  uint32_t i2 = mesh_ptr->indices[index * 3 + 2];
+  uint32_t i0 = mesh_ptr->index_at(index * 3);
+  uint32_t i1 = mesh_ptr->index_at(index * 3 + 1);
+  uint32_t i2 = mesh_ptr->index_at(index * 3 + 2);
 
-  const Vec3 &v0 = mesh_ptr->vertices[i0].vertex;
-  const Vec3 &v1 = mesh_ptr->vertices[i1].vertex;
-  const Vec3 &v2 = mesh_ptr->vertices[i2].vertex;
+  Vec3 v0 = mesh_ptr->position(i0);
+  Vec3 v1 = mesh_ptr->position(i1);
+  Vec3 v2 = mesh_ptr->position(i2);
 
   // 找出三个顶点的 X, Y, Z 的最小值和最大值
   Vec3 min_v(std::min({v0.x(), v1.x(), v2.x()}),
@@ -124,18 +137,18 @@ bool Triangle::bounding_box(float time0, float time1, AABB &output_box) const {
 }
 
 float Triangle::pdf_value(const Vec3 &o, const Vec3 &v) const {
-  uint32_t i0 = mesh_ptr->indices[index * 3];
-  uint32_t i1 = mesh_ptr->indices[index * 3 + 1];
-  uint32_t i2 = mesh_ptr->indices[index * 3 + 2];
+  uint32_t i0 = mesh_ptr->index_at(index * 3);
+  uint32_t i1 = mesh_ptr->index_at(index * 3 + 1);
+  uint32_t i2 = mesh_ptr->index_at(index * 3 + 2);
 
   hit_record rec;
   // 如果这个方向没有击中三角形，概率为 0
   if (!this->hit(Ray(o, v), 0.001f, 1e9, rec))
     return 0.0f;
 
-  const Vec3 &v0 = mesh_ptr->vertices[i0].vertex;
-  const Vec3 &v1 = mesh_ptr->vertices[i1].vertex;
-  const Vec3 &v2 = mesh_ptr->vertices[i2].vertex;
+  Vec3 v0 = mesh_ptr->position(i0);
+  Vec3 v1 = mesh_ptr->position(i1);
+  Vec3 v2 = mesh_ptr->position(i2);
 
   // 计算三角形面积 Area = 0.5 * |(v1 - v0) x (v2 - v0)|
   float A = 0.5f * cross(v1 - v0, v2 - v0).length();
@@ -151,13 +164,13 @@ float Triangle::pdf_value(const Vec3 &o, const Vec3 &v) const {
 }
 
 Vec3 Triangle::random(const Vec3 &o) const {
-  uint32_t i0 = mesh_ptr->indices[index * 3];
-  uint32_t i1 = mesh_ptr->indices[index * 3 + 1];
-  uint32_t i2 = mesh_ptr->indices[index * 3 + 2];
+  uint32_t i0 = mesh_ptr->index_at(index * 3);
+  uint32_t i1 = mesh_ptr->index_at(index * 3 + 1);
+  uint32_t i2 = mesh_ptr->index_at(index * 3 + 2);
 
-  const Vec3 &v0 = mesh_ptr->vertices[i0].vertex;
-  const Vec3 &v1 = mesh_ptr->vertices[i1].vertex;
-  const Vec3 &v2 = mesh_ptr->vertices[i2].vertex;
+  Vec3 v0 = mesh_ptr->position(i0);
+  Vec3 v1 = mesh_ptr->position(i1);
+  Vec3 v2 = mesh_ptr->position(i2);
 
   // 获取均匀采样的重心坐标
   Vec3 bary = tracer::math::random_triangle_barycentric();
@@ -21,7 +21,7 @@ float charlie_brdf(const Ray &r_in, const Ray &scattered, const Vec3 &normal,
 bool Cloth::scatter(const Ray &r_in, const hit_record &rec,
                     scatter_record &srec) const {
   srec.is_specular = false;
-  srec.attenuation = albedo->value(rec.u, rec.v, rec.p);
+  srec.attenuation = albedo->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
 
   Vec3 view_dir = -unit_vector(r_in.direction());
 
@@ -17,7 +17,8 @@ bool GlossyPlastic::scatter(const Ray &r_in, const hit_record &rec,
     srec.attenuation = Color(1.0f, 1.0f, 1.0f);
   } else {
     srec.is_specular = false;
-    srec.attenuation = albedo->value(rec.u, rec.v, rec.p);
+    srec.attenuation =
+        albedo->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
     srec.pdf_ptr = std::make_shared<Cosine_pdf>(rec.normal);
   }
   return true;
@@ -6,7 +6,7 @@ namespace material {
 bool Lambertian::scatter(const Ray &r, const hit_record &rec,
                          scatter_record &srec) const {
   srec.is_specular = false;
-  srec.attenuation = albedo->value(rec.u, rec.v, rec.p);
+  srec.attenuation = albedo->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
   srec.pdf_ptr = std::make_shared<Cosine_pdf>(rec.normal);
   return true;
 }
@@ -24,7 +24,8 @@ bool Plastic::scatter(const Ray &r_in, const hit_record &rec,
   } else {
     // 基底漫反射 (Diffuse/Base)
     srec.is_specular = false;
-    srec.attenuation = albedo->value(rec.u, rec.v, rec.p);
+    srec.attenuation =
+        albedo->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
     srec.pdf_ptr = std::make_shared<Cosine_pdf>(rec.normal);
   }
   return true;
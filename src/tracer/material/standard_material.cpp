@@ -6,31 +6,31 @@ namespace material {
 bool StandardMaterial::scatter(const Ray &r_in, const hit_record &rec,
                                scatter_record &srec) const {
   // 纹理采样
-  Vec3 current_albedo = albedo->value(rec.u, rec.v, rec.p);
+  Vec3 current_albedo =
+      albedo->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
 
   float current_roughness = roughness;
   if (roughness_map) {
-    current_roughness = roughness_map->value(rec.u, rec.v, rec.p).x();
+    current_roughness =
+        roughness_map->sample(rec.u, rec.v, rec.p, rec.uv_footprint).x();
   }
   current_roughness = std::clamp(current_roughness, 0.01f, 1.0f);
 
   float current_metallic = metallic;
   if (metallic_map) {
-    Vec3 ks = metallic_map->value(rec.u, rec.v, rec.p);
+    Vec3 ks = metallic_map->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
     current_metallic = (ks.x() + ks.y() + ks.z()) / 3.0f;
     current_metallic = std::clamp(current_metallic, 0.0f, 1.0f);
   }
 
-  float current_alpha = alpha;
-  if (alpha_map) {
-    current_alpha = alpha_map->value(rec.u, rec.v, rec.p).x();
-    current_alpha = std::clamp(current_alpha, 0.0f, 1.0f);
-  }
+  // alpha_map 作为镂空在求交阶段处理（见 alpha_test），能走到这里的命中点
+  // 都是不透明的；常量 alpha（d / Tr）仍然走下面的透射分支
+  float current_alpha = alpha_map ? 1.0f : alpha;
 
   // 法线贴图
   Vec3 hit_normal = rec.normal;
   if (normal_map) {
-    Vec3 tn = normal_map->value(rec.u, rec.v, rec.p);
+    Vec3 tn = normal_map->sample(rec.u, rec.v, rec.p, rec.uv_footprint);
     tn = 2.0f * tn - Vec3(1.0f, 1.0f, 1.0f);
     tn = normalize(tn);
     hit_normal = normalize(tn.x() * rec.tangent + tn.y() * rec.bitangent +
@@ -95,6 +95,17 @@ bool StandardMaterial::scatter(const Ray &r_in, const hit_record &rec,
   return true;
 }
 
+bool StandardMaterial::alpha_test(float u, float v) const {
+  return alpha_map->value(u, v, Point3()).x() >= alpha_cutoff;
+}
+
+bool StandardMaterial::opaque_in_rect(float u0, float v0, float u1,
+                                      float v1) const {
+  if (!alpha_map)
+    return true;
+  return alpha_map->min_x_in_rect(u0, v0, u1, v1) >= alpha_cutoff;
+}
+
 float StandardMaterial::scattering_pdf(const Ray &r_in, const hit_record &rec,
                                        const scatter_record &srec,
                                        const Ray &scattered) const {
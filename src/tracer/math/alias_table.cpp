@@ -0,0 +1,59 @@
+#include "tracer/math/alias_table.h"
+#include <algorithm>
+
+namespace tracer {
+namespace math {
+
+AliasTable::AliasTable(const std::vector<float> &weights) {
+  const size_t n = weights.size();
+  if (n == 0)
+    return;
+
+  double sum = 0.0;
+  for (float w : weights)
+    sum += std::max(w, 0.0f);
+
+  bins.resize(n);
+  pmf_.resize(n);
+  // 权重全为 0 时退化为均匀分布
+  for (size_t i = 0; i < n; ++i)
+    pmf_[i] = sum > 0.0 ? static_cast<float>(std::max(weights[i], 0.0f) / sum)
+                        : 1.0f / static_cast<float>(n);
+
+  std::vector<float> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = pmf_[i] * static_cast<float>(n);
+    (scaled[i] < 1.0f ? small : large).push_back(static_cast<uint32_t>(i));
+  }
+
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back();
+    small.pop_back();
+    uint32_t l = large.back();
+    large.pop_back();
+
+    bins[s].q = scaled[s];
+    bins[s].alias = l;
+
+    scaled[l] -= 1.0f - scaled[s];
+    (scaled[l] < 1.0f ? small : large).push_back(l);
+  }
+
+  // 浮点误差残留的格子概率视为 1
+  for (uint32_t i : small)
+    bins[i] = {1.0f, i};
+  for (uint32_t i : large)
+    bins[i] = {1.0f, i};
+}
+
+uint32_t AliasTable::sample(float u) const {
+  const size_t n = bins.size();
+  float x = u * static_cast<float>(n);
+  uint32_t i = std::min(static_cast<uint32_t>(x), static_cast<uint32_t>(n - 1));
+  float frac = x - static_cast<float>(i);
+  return frac < bins[i].q ? i : bins[i].alias;
+}
+
+} // namespace math
+} // namespace tracer
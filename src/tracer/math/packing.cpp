@@ -0,0 +1,137 @@
+#include "tracer/math/packing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace tracer {
+namespace math {
+
+namespace {
+
+// 把单位向量投影到八面体上，再把下半球折叠到 [-1,1]^2 正方形
+void oct_project(const Vec3 &n, float &x, float &y) {
+  float l1 = std::fabs(n.x()) + std::fabs(n.y()) + std::fabs(n.z());
+  if (l1 < 1e-20f) {
+    x = 0.0f;
+    y = 0.0f;
+    return;
+  }
+  x = n.x() / l1;
+  y = n.y() / l1;
+  if (n.z() < 0.0f) {
+    float ox = x;
+    x = (1.0f - std::fabs(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+    y = (1.0f - std::fabs(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+  }
+}
+
+Vec3 oct_unproject(float x, float y) {
+  float z = 1.0f - std::fabs(x) - std::fabs(y);
+  if (z < 0.0f) {
+    float ox = x;
+    x = (1.0f - std::fabs(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+    y = (1.0f - std::fabs(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+  }
+  return normalize(Vec3(x, y, z));
+}
+
+uint32_t to_snorm(float v, int bits) {
+  float scale = static_cast<float>((1 << (bits - 1)) - 1);
+  int q = static_cast<int>(std::round(std::clamp(v, -1.0f, 1.0f) * scale));
+  return static_cast<uint32_t>(q) & ((1u << bits) - 1u);
+}
+
+float from_snorm(uint32_t q, int bits) {
+  // 符号扩展
+  int shift = 32 - bits;
+  int s = static_cast<int>(q << shift) >> shift;
+  float scale = static_cast<float>((1 << (bits - 1)) - 1);
+  return std::max(static_cast<float>(s) / scale, -1.0f);
+}
+
+} // namespace
+
+uint32_t oct_encode(const Vec3 &n) {
+  float x, y;
+  oct_project(n, x, y);
+  return to_snorm(x, 16) | (to_snorm(y, 16) << 16);
+}
+
+Vec3 oct_decode(uint32_t packed) {
+  return oct_unproject(from_snorm(packed & 0xFFFFu, 16),
+                       from_snorm(packed >> 16, 16));
+}
+
+uint32_t oct_encode_tangent(const Vec3 &t, float sign) {
+  float x, y;
+  oct_project(t, x, y);
+  uint32_t packed = to_snorm(x, 16) | (to_snorm(y, 15) << 16);
+  if (sign < 0.0f)
+    packed |= 0x80000000u;
+  return packed;
+}
+
+Vec3 oct_decode_tangent(uint32_t packed, float &sign) {
+  sign = (packed & 0x80000000u) ? -1.0f : 1.0f;
+  return oct_unproject(from_snorm(packed & 0xFFFFu, 16),
+                       from_snorm((packed >> 16) & 0x7FFFu, 15));
+}
+
+uint16_t float_to_half(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000u;
+  int32_t exp = static_cast<int32_t>((x >> 23) & 0xFFu) - 127 + 15;
+  uint32_t mant = x & 0x7FFFFFu;
+
+  if (((x >> 23) & 0xFFu) == 0xFFu) // Inf / NaN
+    return static_cast<uint16_t>(sign | 0x7C00u | (mant ? 0x200u : 0u));
+  if (exp >= 31) // 溢出，饱和为 Inf
+    return static_cast<uint16_t>(sign | 0x7C00u);
+  if (exp <= 0) { // 非规格化数或下溢
+    if (exp < -10)
+      return static_cast<uint16_t>(sign);
+    mant |= 0x800000u;
+    uint32_t shift = static_cast<uint32_t>(14 - exp);
+    uint32_t half_mant = mant >> shift;
+    // 就近舍入
+    if ((mant >> (shift - 1)) & 1u)
+      half_mant += 1;
+    return static_cast<uint16_t>(sign | half_mant);
+  }
+  uint32_t h = sign | (static_cast<uint32_t>(exp) << 10) | (mant >> 13);
+  if (mant & 0x1000u) // 就近舍入（进位可能溢出到指数，结果仍然正确）
+    h += 1;
+  return static_cast<uint16_t>(h);
+}
+
+float half_to_float(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t exp = (h >> 10) & 0x1Fu;
+  uint32_t mant = h & 0x3FFu;
+  uint32_t x;
+
+  if (exp == 0) {
+    if (mant == 0) {
+      x = sign;
+    } else { // 非规格化数：规格化后再组装
+      exp = 127 - 15 + 1;
+      while ((mant & 0x400u) == 0) {
+        mant <<= 1;
+        --exp;
+      }
+      mant &= 0x3FFu;
+      x = sign | (exp << 23) | (mant << 13);
+    }
+  } else if (exp == 31) {
+    x = sign | 0x7F800000u | (mant << 13);
+  } else {
+    x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+  }
+
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+} // namespace math
+} // namespace tracer
@@ -3,12 +3,20 @@
 namespace tracer {
 namespace obj_parser {
 
-Object::Object(const std::string &path) {
-  std::ifstream file(path);
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  source = buffer.str();
-  if (source.empty()) {
+// 网格缓存的键：OBJ 和它引用的材质库的内容，材质库决定材质下标
+static uint64_t source_key(const ObjReader &reader, const std::string &dir,
+                           const std::vector<std::string> &libs) {
+  uint64_t h = utils::content_hash(reader.data(), reader.size());
+  for (const auto &name : libs) {
+    utils::MappedFile mtl(dir + "/" + name);
+    h = utils::content_hash(mtl.data(), mtl.size(), h);
+  }
+  return geometry::MeshCache::key(h);
+}
+
+Object::Object(const std::string &path, CullMode cull) {
+  ObjReader reader(path);
+  if (!reader.ok()) {
     std::cerr << "加载模型文件失败: " << path << std::endl;
     return;
   }
@@ -16,15 +24,55 @@ Object::Object(const std::string &path) {
   if (last_sep != std::string::npos) {
     dir = path.substr(0, last_sep); // 不包含分隔符
   }
-  Lexer lexer(source);
-  o_parser.init_settings(lexer.tokenizer());
-  o_parser.parse();
-  for (const auto &mtl : o_parser.mtl_labels) {
-    Value v;
-    mtl->evaluate(v);
+  mesh = std::make_unique<geometry::Mesh>();
+  mesh->cull_mode = cull;
+  std::cout << "正在加载模型: " << path << std::endl;
 
-    std::cout << "正在解析材质: " << v.v_mat_path << std::endl;
-    std::ifstream mtl_file(dir + "/" + v.v_mat_path);
+  // 两条互不依赖的链：材质库 → 材质与贴图解码，OBJ 解析 → 几何数据；
+  // 几何数据还需要材质名到下标的映射。mtllib 在解析 OBJ 之前先扫描出来，
+  // 材质库和贴图就可以与 OBJ 的解析同时加载
+  const std::vector<std::string> names = reader.mtllibs();
+  utils::AssetPipeline &pipeline = utils::AssetPipeline::instance();
+  auto libs = pipeline.submit([this, names]() { parse_materials(names); });
+
+  // 网格缓存命中时几何数据和 BVH 直接从缓存读取，只需要构建材质。
+  // 校验缓存中的材质下标需要材质数量，所以先等材质库解析完（MTL 文本
+  // 很小，贴图解码在 build_materials() 中）
+  geometry::MeshCache &cache = geometry::MeshCache::instance();
+  bool cached = false;
+  if (cache.enabled()) {
+    mesh->cache_key = source_key(reader, dir, names);
+    pipeline.wait(libs);
+    const uint32_t material_count = static_cast<uint32_t>(
+        std::max<size_t>(1, mtl_value.v_params.size()));
+    cached = cache.load(mesh->cache_key, material_count, *mesh);
+  }
+
+  utils::AssetPipeline::Job<void> parse, geometry;
+  if (!cached) {
+    parse = pipeline.submit([this, &reader]() {
+      auto start = std::chrono::steady_clock::now();
+      reader.read(raw);
+      parse_seconds = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    });
+    geometry = pipeline.submit([this]() { build_geometry(); },
+                               {libs.node, parse.node});
+  }
+  pipeline.wait(libs);
+  build_materials();
+  if (!cached) {
+    pipeline.wait(parse);
+    pipeline.wait(geometry);
+  }
+  std::cout << "模型加载完成!" << std::endl;
+}
+
+void Object::parse_materials(const std::vector<std::string> &names) {
+  for (const auto &name : names) {
+    std::cout << "正在解析材质: " << name << std::endl;
+    std::ifstream mtl_file(dir + "/" + name);
     std::stringstream mtl_buffer;
     mtl_buffer << mtl_file.rdbuf();
     std::string mtl_source = mtl_buffer.str();
@@ -33,47 +81,202 @@ Object::Object(const std::string &path) {
     mtl_parser.parse_mtl();
     std::cout << "材质解析完成!" << std::endl;
   }
-  mesh = std::make_unique<geometry::Mesh>();
-  std::cout << "正在加载模型: " << path << std::endl;
-  this->builder();
-  std::cout << "模型加载完成!" << std::endl;
-}
-
-void Object::builder() {
-  std::vector<Vec3> vertices;
-  std::vector<Vec3> normals;
-  std::vector<Vec2> texture_coords;
-  std::vector<Face> faces;
-
-  std::unordered_map<std::string, uint32_t> mat_map;
-
-  Value value;
-  Value mtl_value;
-
-  for (const auto &node : o_parser.nodes) {
-    node->evaluate(value);
-    if (value.v_type == Value::ValueType::V_VERTEX) {
-      vertices.push_back(value.v_vertex);
-    } else if (value.v_type == Value::ValueType::V_NORMAL) {
-      normals.push_back(value.v_normal);
-    } else if (value.v_type == Value::ValueType::V_TEXTURE) {
-      texture_coords.push_back(value.v_texture_coord);
-    } else if (value.v_type == Value::ValueType::V_FACE) {
-      // 正常来说，usemtl 在 f 前出现，所以，按出现顺序，f 块设置最新的材质名
-      value.v_face.mat = value.v_usemtl_name;
-      faces.push_back(value.v_face);
-    }
-    // 其他属性暂时忽略
-  }
 
   for (const auto &mtl_node : mtl_parser.nodes) {
     mtl_node->evaluate(mtl_value);
   }
 
   uint32_t m_idx = 0;
-  for (const auto &param : mtl_value.v_params) {
+  for (const auto &param : mtl_value.v_params)
     mat_map[param.mat_name] = m_idx++;
+}
+
+// 面顶点 (v, vt, vn) 的 64 位散列，高位用来分组，低位用来定位表项
+static uint64_t hash_corner(const Index &index) {
+  uint64_t h = (uint64_t(index.idx[0]) << 32 | index.idx[1]) *
+               0x9e3779b97f4a7c15ull;
+  h ^= (h >> 29) ^ (uint64_t(index.idx[2]) * 0xbf58476d1ce4e5b9ull);
+  h *= 0x94d049bb133111ebull;
+  return h ^ (h >> 31);
+}
+
+// 每个面顶点的 (v, vt, vn) 组合第一次出现的位置，first[i] == i 表示第一次
+// 出现。按散列的高位把面顶点分成若干组，组间互不相交，各组用一张按组大小
+// 预先分配的开放寻址表独立去重，可以并行；组内按下标顺序处理，结果与
+// 顺序插入一张哈希表完全相同
+static std::vector<uint32_t>
+first_occurrence(const std::vector<Index> &corners) {
+  const int64_t n = static_cast<int64_t>(corners.size());
+  std::vector<uint64_t> hashes(n);
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i)
+    hashes[i] = hash_corner(corners[i]);
+
+  // 小网格只分一组，省去分组的开销
+  const int shard_bits = n < (int64_t(1) << 16) ? 0 : 6;
+  const size_t shards = size_t(1) << shard_bits;
+  auto shard_of = [&](int64_t i) -> size_t {
+    return shard_bits == 0 ? 0 : hashes[i] >> (64 - shard_bits);
+  };
+
+  // 分组用计数排序：各块统计每组的数量，按 (组, 块) 的顺序求前缀和后
+  // 并行写回，组内仍保持下标的先后顺序
+  const int64_t block = int64_t(1) << 16;
+  const int64_t blocks = (n + block - 1) / block;
+  std::vector<size_t> offsets(blocks * shards, 0);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i)
+      ++offsets[b * shards + shard_of(i)];
+  }
+  std::vector<size_t> shard_begin(shards + 1, 0);
+  size_t sum = 0;
+  for (size_t s = 0; s < shards; ++s) {
+    shard_begin[s] = sum;
+    for (int64_t b = 0; b < blocks; ++b) {
+      size_t count = offsets[b * shards + s];
+      offsets[b * shards + s] = sum;
+      sum += count;
+    }
+  }
+  shard_begin[shards] = sum;
+  std::vector<uint32_t> order(n);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i)
+      order[offsets[b * shards + shard_of(i)]++] = static_cast<uint32_t>(i);
+  }
+
+  // 表项存散列的高 32 位和面顶点下标，散列不同时不必读取 corners
+  struct Slot {
+    uint32_t tag;
+    uint32_t corner;
+  };
+  static constexpr uint32_t EMPTY = 0xffffffffu;
+  std::vector<uint32_t> first(n);
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t s = 0; s < static_cast<int64_t>(shards); ++s) {
+    const size_t begin = shard_begin[s], end = shard_begin[s + 1];
+    size_t capacity = 16;
+    while (capacity < 2 * (end - begin))
+      capacity *= 2;
+    const size_t mask = capacity - 1;
+    std::vector<Slot> table(capacity, Slot{0, EMPTY});
+    for (size_t k = begin; k < end; ++k) {
+      const uint32_t c = order[k];
+      const uint32_t tag = static_cast<uint32_t>(hashes[c] >> 32);
+      size_t slot = hashes[c] & mask;
+      while (true) {
+        Slot &entry = table[slot];
+        if (entry.corner == EMPTY) {
+          entry = Slot{tag, c};
+          first[c] = c;
+          break;
+        }
+        if (entry.tag == tag && corners[entry.corner] == corners[c]) {
+          first[c] = entry.corner;
+          break;
+        }
+        slot = (slot + 1) & mask;
+      }
+    }
+  }
+  return first;
+}
 
+void Object::build_geometry() {
+  const int64_t triangles = static_cast<int64_t>(raw.face_materials.size());
+  const int64_t n = 3 * triangles;
+
+  // OBJ 中的材质名换成材质下标，没有 usemtl 或者找不到的名字用 0 号材质
+  std::vector<uint32_t> material_ids(raw.material_names.size(), 0);
+  for (size_t i = 0; i < raw.material_names.size(); ++i) {
+    auto it = mat_map.find(raw.material_names[i]);
+    if (it != mat_map.end())
+      material_ids[i] = it->second;
+  }
+  mesh->material_indices.resize(triangles);
+#pragma omp parallel for schedule(static)
+  for (int64_t t = 0; t < triangles; ++t) {
+    uint32_t material = raw.face_materials[t];
+    mesh->material_indices[t] =
+        material == ObjGeometry::NO_MATERIAL ? 0 : material_ids[material];
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<uint32_t> first = first_occurrence(raw.corners);
+
+  // 顶点按第一次出现的顺序编号：各块先数出新顶点的个数，前缀和得到
+  // 每块的起始编号，再并行写出顶点，重复的面顶点最后取第一次出现处的编号
+  const int64_t block = int64_t(1) << 16;
+  const int64_t blocks = (n + block - 1) / block;
+  std::vector<uint32_t> base(blocks + 1, 0);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    uint32_t count = 0;
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i)
+      count += first[i] == static_cast<uint32_t>(i);
+    base[b + 1] = count;
+  }
+  for (int64_t b = 0; b < blocks; ++b)
+    base[b + 1] += base[b];
+
+  mesh->vertices.resize(base[blocks]);
+  mesh->indices.resize(n);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    uint32_t idx = base[b];
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+      if (first[i] != static_cast<uint32_t>(i))
+        continue;
+      // 0: vertex index, 1: texture coord index, 2: normal index
+      const Index &index = raw.corners[i];
+      uint32_t vertex_index = index.idx[0] - 1;
+      uint32_t texture_index = index.idx[1] - 1;
+      uint32_t normal_index = index.idx[2] - 1;
+      mesh->vertices[idx] = geometry::Vertex{
+          vertex_index < raw.positions.size() ? raw.positions[vertex_index]
+                                              : Vec3(0.0f, 0.0f, 0.0f),
+          normal_index < raw.normals.size() ? raw.normals[normal_index]
+                                            : Vec3(0.0f, 0.0f, 1.0f),
+          Vec3(0, 0, 0),
+          1.0f,
+          texture_index < raw.uvs.size() ? raw.uvs[texture_index] : Vec2(),
+      };
+      mesh->indices[i] = idx++;
+    }
+  }
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i) {
+    if (first[i] != static_cast<uint32_t>(i))
+      mesh->indices[i] = mesh->indices[first[i]];
+  }
+  dedup_seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  raw = ObjGeometry();
+}
+
+void Object::build_materials() {
+  // 每张贴图一个解码任务，材质里先留空，全部提交后统一取回；
+  // 同一张图片常被多个材质引用（如 Sponza），只提交一次
+  utils::AssetPipeline &pipeline = utils::AssetPipeline::instance();
+  using TextureJob = utils::AssetPipeline::Job<std::shared_ptr<Texture>>;
+  std::unordered_map<std::string, TextureJob> jobs;
+  std::vector<std::pair<std::shared_ptr<Texture> *, TextureJob>> slots;
+  auto load_texture = [&](std::shared_ptr<Texture> &slot,
+                          const std::string &name) {
+    auto it = jobs.find(name);
+    if (it == jobs.end()) {
+      std::string path = dir + "/" + name;
+      auto job = pipeline.submit(
+          [path]() { return texture::TextureCache::instance().load(path); });
+      it = jobs.emplace(name, job).first;
+    }
+    slots.emplace_back(&slot, it->second);
+  };
+
+  for (const auto &param : mtl_value.v_params) {
     // 粗糙度：Ns (Phong 高光指数) → roughness
     float roughness = std::sqrt(2.0f / (param.Ns + 2.0f));
     // 金属度：从 Ks 亮度估算
@@ -96,79 +299,64 @@ void Object::builder() {
     if (param.map_Kd.empty()) {
       mat->albedo = std::make_shared<texture::SolidColor>(param.Kd);
     } else {
-      mat->albedo = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Kd).c_str());
+      load_texture(mat->albedo, param.map_Kd);
     }
 
     // 粗糙度贴图：优先使用 PBR map_Pr，否则使用 map_Ns
     if (!param.map_Pr.empty()) {
-      mat->roughness_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Pr).c_str());
+      load_texture(mat->roughness_map, param.map_Pr);
     } else if (!param.map_Ns.empty()) {
-      mat->roughness_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Ns).c_str());
+      load_texture(mat->roughness_map, param.map_Ns);
     } else {
       mat->roughness = roughness;
     }
 
     // 金属度贴图：优先使用 PBR map_Pm，否则使用 map_Ks
     if (!param.map_Pm.empty()) {
-      mat->metallic_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Pm).c_str());
+      load_texture(mat->metallic_map, param.map_Pm);
     } else if (!param.map_Ks.empty()) {
-      mat->metallic_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Ks).c_str());
+      load_texture(mat->metallic_map, param.map_Ks);
     } else {
       mat->metallic = metallic;
     }
 
     // AO 贴图：优先使用 PBR map_Po，否则使用 map_Ka
     if (!param.map_Po.empty()) {
-      mat->ambient_occlusion = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Po).c_str());
+      load_texture(mat->ambient_occlusion, param.map_Po);
     } else if (!param.map_Ka.empty()) {
-      mat->ambient_occlusion = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Ka).c_str());
+      load_texture(mat->ambient_occlusion, param.map_Ka);
     }
 
     // 自发光 emissive
     if (!param.map_Ke.empty()) {
-      mat->emissive_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Ke).c_str());
+      load_texture(mat->emissive_map, param.map_Ke);
     } else if (!param.map_Pe.empty()) {
-      mat->emissive_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Pe).c_str());
+      load_texture(mat->emissive_map, param.map_Pe);
     } else {
       mat->emissive_map = std::make_shared<texture::SolidColor>(param.Ke);
     }
 
     // 法线贴图 (map_bump / bump)
     if (!param.map_bump.empty()) {
-      mat->normal_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_bump).c_str());
+      load_texture(mat->normal_map, param.map_bump);
     } else if (!param.bump.empty()) {
-      mat->normal_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.bump).c_str());
+      load_texture(mat->normal_map, param.bump);
     }
 
     // 透明度贴图 (map_d / map_Tr)
     if (!param.map_d.empty()) {
-      mat->alpha_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_d).c_str());
+      load_texture(mat->alpha_map, param.map_d);
     } else if (!param.map_Tr.empty()) {
-      mat->alpha_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_Tr).c_str());
+      load_texture(mat->alpha_map, param.map_Tr);
     } else {
       mat->alpha = alpha;
     }
 
     // 反射贴图 (map_refl / refl)
     if (!param.map_refl.empty()) {
-      mat->reflection_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.map_refl).c_str());
+      load_texture(mat->reflection_map, param.map_refl);
     } else if (!param.refl.empty()) {
-      mat->reflection_map = std::make_shared<texture::ImageTexture>(
-          (dir + "/" + param.refl).c_str());
+      load_texture(mat->reflection_map, param.refl);
     }
 
     // 透射滤镜颜色 Tf
@@ -186,6 +374,24 @@ void Object::builder() {
       mat->double_sided = true;
     }
 
+    // 双面、透射和镂空材质需要看到背面，不参与网格的背面剔除
+    bool cutout = !param.map_d.empty() || !param.map_Tr.empty();
+    if (mat->double_sided || mat->alpha < 1.0f || cutout) {
+      mat->cull_mode = CullMode::None;
+    }
+
+    // 扩展语句 cull none|back|front 显式指定剔除模式，优先于上面的推断
+    if (param.cull == "none") {
+      mat->cull_mode = CullMode::None;
+    } else if (param.cull == "back") {
+      mat->cull_mode = CullMode::Back;
+    } else if (param.cull == "front") {
+      mat->cull_mode = CullMode::Front;
+    } else if (!param.cull.empty()) {
+      std::cerr << "未知的剔除模式 '" << param.cull
+                << "'，忽略。材质: " << param.mat_name << std::endl;
+    }
+
     // 镜面反射基准 specular (F0)
     float spec_val = std::max({param.Ks[0], param.Ks[1], param.Ks[2]});
     mat->specular = std::clamp(spec_val, 0.0f, 1.0f);
@@ -193,46 +399,17 @@ void Object::builder() {
     mesh->materials.push_back(mat);
   }
 
+  for (auto &[slot, job] : slots)
+    *slot = pipeline.wait(job);
+
+  if (!mtl_value.v_params.empty())
+    texture::TextureCache::instance().report();
+
   // 保底，假如没有 mtl 文件的话，使用默认金属材质
   if (mesh->materials.empty()) {
     mesh->materials.push_back(std::make_shared<material::StandardMaterial>(
         Vec3(0.8f, 0.8f, 0.8f), 1.0f, 0.0f));
   }
-
-  std::unordered_map<Index, uint32_t> vertex_map;
-  for (const auto &face : faces) {
-    if (!face.mat.empty()) {
-      mesh->material_indices.push_back(mat_map[face.mat]);
-    } else {
-      mesh->material_indices.push_back(0);
-    }
-
-    for (size_t j = 0; j < 3; j++) {
-      // 0: vertex index, 1: texture coord index, 2: normal index
-      uint32_t vertex_index = face.v[0].idx[j] - 1;
-      uint32_t texture_index = face.v[1].idx[j] - 1;
-      uint32_t normal_index = face.v[2].idx[j] - 1;
-      Index index{face.v[0].idx[j], face.v[1].idx[j], face.v[2].idx[j]};
-      auto it = vertex_map.find(index);
-      if (it == vertex_map.end()) {
-        uint32_t idx = (uint32_t)mesh->vertices.size();
-        mesh->vertices.push_back(geometry::Vertex{
-            vertices[vertex_index],
-            normal_index < normals.size() ? normals[normal_index]
-                                          : Vec3(0.0f, 0.0f, 1.0f),
-            Vec3(0, 0, 0),
-            Vec3(0, 0, 0),
-            texture_index < texture_coords.size()
-                ? texture_coords[texture_index]
-                : Vec2(),
-        });
-        vertex_map[index] = idx;
-        mesh->indices.push_back(idx);
-      } else {
-        mesh->indices.push_back(it->second);
-      }
-    }
-  }
 }
 
 std::shared_ptr<geometry::Mesh> Object::take() { return std::move(mesh); }
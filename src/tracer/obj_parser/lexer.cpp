@@ -28,6 +28,7 @@ Lexer::Lexer(const std::string &src) : source(src) {
   reserved["Tf"] = Token(TokenType::TRANSMISSION_FILTER_COLOR, "Tf");
   reserved["illum"] = Token(TokenType::ILLUMINATION_MODEL, "illum");
   reserved["sharpness"] = Token(TokenType::SHARPNESS, "sharpness");
+  reserved["cull"] = Token(TokenType::CULL, "cull");
 
   reserved["map_Kd"] = Token(TokenType::MAP_KD, "map_Kd");
   reserved["map_Ka"] = Token(TokenType::MAP_KA, "map_Ka");
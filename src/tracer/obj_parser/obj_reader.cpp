@@ -0,0 +1,367 @@
+#include "tracer/obj_parser/obj_reader.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace tracer {
+namespace obj_parser {
+
+// 每块约 4 MB，块数远多于线程数，动态调度时负载比较均衡
+static constexpr size_t CHUNK_BYTES = size_t(4) << 20;
+
+struct ObjCounts {
+  size_t v = 0, vt = 0, vn = 0, tris = 0;
+};
+
+struct ObjChunk {
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  ObjCounts count;                          // 第一遍的统计
+  ObjCounts offset;                         // 本块的写入位置
+  std::vector<std::string> names;           // 本块 usemtl 出现的材质名
+  uint32_t last = ObjGeometry::NO_MATERIAL; // 本块最后一个 usemtl
+  size_t bad = 0;                           // 无法解析的数值个数
+};
+
+enum class LineType { Other, Vertex, TexCoord, Normal, Face, UseMtl, MtlLib };
+
+static bool is_space(char c) { return c == ' ' || c == '\t'; }
+
+static const char *skip_space(const char *p, const char *end) {
+  while (p < end && is_space(*p))
+    ++p;
+  return p;
+}
+
+// 返回本行的类型，p 移到关键字之后
+static LineType line_type(const char *&p, const char *end) {
+  auto keyword = [&](const char *word, size_t n) {
+    if (static_cast<size_t>(end - p) > n && std::memcmp(p, word, n) == 0 &&
+        is_space(p[n])) {
+      p += n;
+      return true;
+    }
+    return false;
+  };
+  if (p == end)
+    return LineType::Other;
+  switch (*p) {
+  case 'v':
+    if (keyword("v", 1))
+      return LineType::Vertex;
+    if (keyword("vt", 2))
+      return LineType::TexCoord;
+    if (keyword("vn", 2))
+      return LineType::Normal;
+    break;
+  case 'f':
+    if (keyword("f", 1))
+      return LineType::Face;
+    break;
+  case 'u':
+    if (keyword("usemtl", 6))
+      return LineType::UseMtl;
+    break;
+  case 'm':
+    if (keyword("mtllib", 6))
+      return LineType::MtlLib;
+    break;
+  }
+  return LineType::Other;
+}
+
+// 依次处理 [begin, end) 中的每一行，行尾的 \r 已去掉
+template <class F>
+static void for_each_line(const char *begin, const char *end, F &&f) {
+  const char *p = begin;
+  while (p < end) {
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *line_end = nl ? nl : end;
+    const char *e = line_end;
+    if (e > p && e[-1] == '\r')
+      --e;
+    f(skip_space(p, e), e);
+    p = line_end + 1;
+  }
+}
+
+static int count_tokens(const char *p, const char *end) {
+  int n = 0;
+  while (true) {
+    p = skip_space(p, end);
+    if (p == end || *p == '#')
+      return n;
+    ++n;
+    while (p < end && !is_space(*p))
+      ++p;
+  }
+}
+
+static std::string rest_of_line(const char *p, const char *end) {
+  p = skip_space(p, end);
+  while (end > p && is_space(end[-1]))
+    --end;
+  return std::string(p, end);
+}
+
+static const char *parse_float(const char *p, const char *end, float &out,
+                               size_t &bad) {
+  p = skip_space(p, end);
+  // from_chars 不接受前导的 '+'
+  if (p < end && *p == '+')
+    ++p;
+  auto [next, ec] = std::from_chars(p, end, out);
+  if (ec != std::errc()) {
+    out = 0.0f;
+    ++bad;
+    while (p < end && !is_space(*p))
+      ++p;
+    return p;
+  }
+  return next;
+}
+
+// 单个面顶点 "v"、"v/vt"、"v//vn" 或 "v/vt/vn"，换算成从 1 开始的索引
+static const char *parse_corner(const char *p, const char *end,
+                                const size_t counts[3], Index &out,
+                                size_t &bad) {
+  out = Index();
+  for (int a = 0; a < 3; ++a) {
+    if (a > 0) {
+      if (p == end || *p != '/')
+        break;
+      ++p;
+    }
+    if (p == end || *p == '/' || is_space(*p))
+      continue;
+    long long raw = 0;
+    auto [next, ec] = std::from_chars(p, end, raw);
+    if (ec != std::errc()) {
+      ++bad;
+      while (p < end && !is_space(*p) && *p != '/')
+        ++p;
+      continue;
+    }
+    p = next;
+    long long resolved =
+        raw < 0 ? static_cast<long long>(counts[a]) + raw + 1 : raw;
+    if (resolved > 0 && resolved <= 0xffffffffll)
+      out.idx[a] = static_cast<uint32_t>(resolved);
+  }
+  // 跳过本组中剩余的字符
+  while (p < end && !is_space(*p))
+    ++p;
+  return p;
+}
+
+static void count_chunk(ObjChunk &chunk) {
+  for_each_line(chunk.begin, chunk.end, [&](const char *p, const char *e) {
+    switch (line_type(p, e)) {
+    case LineType::Vertex:
+      ++chunk.count.v;
+      break;
+    case LineType::TexCoord:
+      ++chunk.count.vt;
+      break;
+    case LineType::Normal:
+      ++chunk.count.vn;
+      break;
+    case LineType::Face: {
+      int n = count_tokens(p, e);
+      if (n >= 3)
+        chunk.count.tris += n - 2;
+      break;
+    }
+    default:
+      break;
+    }
+  });
+}
+
+static void parse_chunk(ObjChunk &chunk, ObjGeometry &out) {
+  Vec3 *positions = out.positions.data() + chunk.offset.v;
+  Vec2 *uvs = out.uvs.data() + chunk.offset.vt;
+  Vec3 *normals = out.normals.data() + chunk.offset.vn;
+  Index *corners = out.corners.data() + 3 * chunk.offset.tris;
+  uint32_t *materials = out.face_materials.data() + chunk.offset.tris;
+
+  ObjCounts n;
+  uint32_t material = ObjGeometry::NO_MATERIAL;
+  std::vector<Index> polygon;
+  for_each_line(chunk.begin, chunk.end, [&](const char *p, const char *e) {
+    switch (line_type(p, e)) {
+    case LineType::Vertex: {
+      float x, y, z;
+      p = parse_float(p, e, x, chunk.bad);
+      p = parse_float(p, e, y, chunk.bad);
+      parse_float(p, e, z, chunk.bad);
+      positions[n.v++] = Vec3(x, y, z);
+      break;
+    }
+    case LineType::TexCoord: {
+      float x, y;
+      p = parse_float(p, e, x, chunk.bad);
+      parse_float(p, e, y, chunk.bad);
+      uvs[n.vt++] = Vec2{x, y};
+      break;
+    }
+    case LineType::Normal: {
+      float x, y, z;
+      p = parse_float(p, e, x, chunk.bad);
+      p = parse_float(p, e, y, chunk.bad);
+      parse_float(p, e, z, chunk.bad);
+      normals[n.vn++] = Vec3(x, y, z);
+      break;
+    }
+    case LineType::Face: {
+      // 负索引相对于到本行为止的全局数量
+      const size_t counts[3] = {chunk.offset.v + n.v, chunk.offset.vt + n.vt,
+                                chunk.offset.vn + n.vn};
+      const int count = count_tokens(p, e);
+      if (count < 3)
+        break;
+      polygon.resize(count);
+      for (int k = 0; k < count; ++k) {
+        p = skip_space(p, e);
+        p = parse_corner(p, e, counts, polygon[k], chunk.bad);
+      }
+      for (int k = 1; k + 1 < count; ++k) {
+        corners[3 * n.tris] = polygon[0];
+        corners[3 * n.tris + 1] = polygon[k];
+        corners[3 * n.tris + 2] = polygon[k + 1];
+        materials[n.tris++] = material;
+      }
+      break;
+    }
+    case LineType::UseMtl: {
+      std::string name = rest_of_line(p, e);
+      auto it = std::find(chunk.names.begin(), chunk.names.end(), name);
+      material = static_cast<uint32_t>(it - chunk.names.begin());
+      if (it == chunk.names.end())
+        chunk.names.push_back(std::move(name));
+      chunk.last = material;
+      break;
+    }
+    default:
+      break;
+    }
+  });
+}
+
+ObjReader::ObjReader(const std::string &path) : file(path) {}
+
+std::vector<std::string> ObjReader::mtllibs() const {
+  std::vector<std::string> names;
+  if (!ok())
+    return names;
+
+  const char *begin = file.data(), *end = begin + file.size();
+  const char *p = begin;
+  while (p < end) {
+    p = static_cast<const char *>(std::memchr(p, 'm', end - p));
+    if (!p)
+      break;
+    const char *q = p++;
+    if (q != begin && q[-1] != '\n')
+      continue;
+    if (line_type(q, end) != LineType::MtlLib)
+      continue;
+    const char *nl = static_cast<const char *>(std::memchr(q, '\n', end - q));
+    const char *e = nl ? nl : end;
+    if (e > q && e[-1] == '\r')
+      --e;
+    std::string name = rest_of_line(q, e);
+    if (!name.empty())
+      names.push_back(std::move(name));
+    p = e;
+  }
+  return names;
+}
+
+void ObjReader::read(ObjGeometry &out) const {
+  out = ObjGeometry();
+  if (!ok())
+    return;
+
+  // 按行边界切块
+  const char *begin = file.data(), *end = begin + file.size();
+  const size_t count = std::max<size_t>(1, file.size() / CHUNK_BYTES);
+  std::vector<ObjChunk> chunks(count);
+  for (size_t i = 0; i < count; ++i) {
+    const char *p = i == 0 ? begin : chunks[i - 1].end;
+    const char *target = begin + file.size() / count * (i + 1);
+    const char *e = end;
+    if (i + 1 < count) {
+      const char *nl =
+          target > p ? static_cast<const char *>(
+                           std::memchr(target, '\n', end - target))
+                     : p - 1;
+      e = nl ? nl + 1 : end;
+    }
+    chunks[i].begin = p;
+    chunks[i].end = e;
+  }
+
+  const int64_t n = static_cast<int64_t>(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t i = 0; i < n; ++i)
+    count_chunk(chunks[i]);
+
+  ObjCounts total;
+  for (ObjChunk &chunk : chunks) {
+    chunk.offset = total;
+    total.v += chunk.count.v;
+    total.vt += chunk.count.vt;
+    total.vn += chunk.count.vn;
+    total.tris += chunk.count.tris;
+  }
+  out.positions.resize(total.v);
+  out.uvs.resize(total.vt);
+  out.normals.resize(total.vn);
+  out.corners.resize(3 * total.tris);
+  out.face_materials.resize(total.tris);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t i = 0; i < n; ++i)
+    parse_chunk(chunks[i], out);
+
+  // 合并各块的材质名；块开头、第一个 usemtl 之前的三角形沿用
+  // 前面各块最后一个 usemtl
+  std::unordered_map<std::string, uint32_t> ids;
+  std::vector<std::vector<uint32_t>> remap(chunks.size());
+  std::vector<uint32_t> inherited(chunks.size());
+  uint32_t current = ObjGeometry::NO_MATERIAL;
+  size_t bad = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    for (const std::string &name : chunks[i].names) {
+      auto it = ids.emplace(name, static_cast<uint32_t>(ids.size())).first;
+      if (it->second == out.material_names.size())
+        out.material_names.push_back(name);
+      remap[i].push_back(it->second);
+    }
+    inherited[i] = current;
+    if (chunks[i].last != ObjGeometry::NO_MATERIAL)
+      current = remap[i][chunks[i].last];
+    bad += chunks[i].bad;
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t i = 0; i < n; ++i) {
+    const ObjChunk &chunk = chunks[i];
+    uint32_t *materials = out.face_materials.data() + chunk.offset.tris;
+    for (size_t t = 0; t < chunk.count.tris; ++t) {
+      materials[t] = materials[t] == ObjGeometry::NO_MATERIAL
+                         ? inherited[i]
+                         : remap[i][materials[t]];
+    }
+  }
+
+  if (bad > 0)
+    std::cerr << "OBJ 中有 " << bad << " 个数值无法解析，已按 0 处理。"
+              << std::endl;
+}
+
+} // namespace obj_parser
+} // namespace tracer
@@ -244,6 +244,8 @@ std::unique_ptr<MaterialParamsNode> ObjParser::make_newmtl() {
       tex_params.Tf = make_vector3();
     } else if (token.type == TokenType::SHARPNESS) {
       tex_params.sharpness = make_number();
+    } else if (token.type == TokenType::CULL) {
+      tex_params.cull = make_string();
     } else if (token.type == TokenType::MAP_KD) {
       tex_params.map_Kd = make_string();
     } else if (token.type == TokenType::MAP_KA) {
@@ -18,6 +18,10 @@ BasicType Environment::get(const std::string &name) {
   throw std::runtime_error("Undefined variable: " + name);
 }
 
+bool Environment::has(const std::string &name) const {
+  return values.count(name) || (outer && outer->has(name));
+}
+
 LambdaNode::LambdaNode(std::string name, std::shared_ptr<ASTNode> body)
     : param_name(std::move(name)), body(std::move(body)) {}
 
@@ -109,6 +113,12 @@ SphereNode::SphereNode(std::shared_ptr<ASTNode> center,
     : center_expr(std::move(center)), radius_expr(std::move(radius)),
       material_expr(std::move(mat)) {}
 
+SunNode::SunNode(std::shared_ptr<ASTNode> direction,
+                 std::shared_ptr<ASTNode> angle,
+                 std::shared_ptr<ASTNode> radiance)
+    : direction_expr(std::move(direction)), angle_expr(std::move(angle)),
+      radiance_expr(std::move(radiance)) {}
+
 HeartNode::HeartNode(std::shared_ptr<ASTNode> center,
                      std::shared_ptr<ASTNode> rho, std::shared_ptr<ASTNode> mat,
                      std::shared_ptr<ASTNode> rot)
@@ -129,9 +139,10 @@ OceanNode::OceanNode(std::shared_ptr<ASTNode> nx, std::shared_ptr<ASTNode> ny,
       height_expr(std::move(height)) {}
 
 MeshNode::MeshNode(std::shared_ptr<ASTNode> mode_path,
-                   std::shared_ptr<ASTNode> pos, std::shared_ptr<ASTNode> rot)
+                   std::shared_ptr<ASTNode> pos, std::shared_ptr<ASTNode> rot,
+                   std::shared_ptr<ASTNode> cull)
     : model_path_expr(std::move(mode_path)), position_expr(std::move(pos)),
-      rot_expr(std::move(rot)) {}
+      rot_expr(std::move(rot)), cull_expr(std::move(cull)) {}
 
 TranslateNode::TranslateNode(std::shared_ptr<ASTNode> object,
                              std::shared_ptr<ASTNode> offset)
@@ -334,7 +345,7 @@ BasicType LambertianNode::evaluate(std::shared_ptr<Environment> env) {
     return BasicType(std::make_shared<material::Lambertian>(albedo.t_vector3));
   } else {
     return BasicType(std::make_shared<material::Lambertian>(
-        std::make_shared<texture::ImageTexture>(albedo.t_string.c_str())));
+        texture::TextureCache::instance().load(albedo.t_string)));
   }
 }
 
@@ -434,6 +445,17 @@ BasicType SphereNode::evaluate(std::shared_ptr<Environment> env) {
   return BasicType(sphere);
 }
 
+BasicType SunNode::evaluate(std::shared_ptr<Environment> env) {
+  BasicType direction = direction_expr->evaluate(env);
+  BasicType angle = angle_expr->evaluate(env);
+  BasicType radiance = radiance_expr->evaluate(env);
+  if (angle.tag == BasicType::T_INT)
+    angle.t_float = static_cast<float>(angle.t_integer);
+  std::shared_ptr<hittable> sun = std::make_shared<geometry::DistantLight>(
+      direction.t_vector3, angle.t_float, radiance.t_vector3);
+  return BasicType(sun);
+}
+
 BasicType HeartNode::evaluate(std::shared_ptr<Environment> env) {
   BasicType center = center_expr->evaluate(env);
   BasicType rho = rho_expr->evaluate(env);
@@ -482,11 +504,67 @@ BasicType OceanNode::evaluate(std::shared_ptr<Environment> env) {
       &*simulator, mat.t_material, lambda.t_float, height.t_float));
 }
 
+CullMode MeshNode::cull_mode(std::shared_ptr<Environment> env) {
+  // 可选的剔除模式："none" / "back" / "front"
+  CullMode cull = CullMode::None;
+  if (cull_expr) {
+    std::string mode = cull_expr->evaluate(env).t_string;
+    if (mode == "back")
+      cull = CullMode::Back;
+    else if (mode == "front")
+      cull = CullMode::Front;
+    else if (mode != "none")
+      throw std::runtime_error("Unknown cull mode: " + mode);
+  }
+  return cull;
+}
+
+static std::shared_ptr<geometry::Mesh> load_model(const std::string &path,
+                                                  CullMode cull) {
+  obj_parser::Object obj(path, cull);
+  std::shared_ptr<geometry::Mesh> model = obj.take();
+  auto start = std::chrono::steady_clock::now();
+  model->finalize();
+  std::chrono::duration<double> finalize =
+      std::chrono::steady_clock::now() - start;
+  const geometry::Mesh::FinalizeTimes &t = model->finalize_times;
+  printf("%s: 解析 %.3f s, 顶点去重 %.3f s, 预处理 %.3f s "
+         "(%zu 个三角形, %zu 个顶点)\n",
+         path.c_str(), obj.parse_seconds, obj.dedup_seconds,
+         finalize.count(), model->triangle_count(), model->vertex_count());
+  printf("  预处理: 包围盒 %.3f s, 平滑法线 %.3f s, 切线 %.3f s, "
+         "面积表 %.3f s, BVH %.3f s\n",
+         t.bounds, t.normals, t.tangents, t.area_cdf, t.bvh);
+  return model;
+}
+
+void MeshNode::prefetch(std::shared_ptr<Environment> env) {
+  try {
+    pending_path = model_path_expr->evaluate(env).t_string;
+    pending_cull = cull_mode(env);
+  } catch (...) {
+    return;
+  }
+  pending = utils::AssetPipeline::instance().submit(
+      [path = pending_path, cull = pending_cull]() {
+        return load_model(path, cull);
+      });
+}
+
 BasicType MeshNode::evaluate(std::shared_ptr<Environment> env) {
   BasicType model_path = model_path_expr->evaluate(env);
   BasicType position = position_expr->evaluate(env);
-  obj_parser::Object obj(model_path.t_string);
-  std::shared_ptr<hittable> mesh = obj.take();
+  CullMode cull = cull_mode(env);
+
+  std::shared_ptr<geometry::Mesh> model;
+  if (pending.valid() && pending_path == model_path.t_string &&
+      pending_cull == cull) {
+    model = utils::AssetPipeline::instance().wait(pending);
+    pending = {};
+  } else {
+    model = load_model(model_path.t_string, cull);
+  }
+  std::shared_ptr<hittable> mesh = model;
 
   if (rot_expr) {
     BasicType rot = rot_expr->evaluate(env);
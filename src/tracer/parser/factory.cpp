@@ -1,4 +1,5 @@
 #include "tracer/parser/factory.h"
+#include <chrono>
 
 namespace tracer {
 namespace parser {
@@ -35,6 +36,8 @@ void Factory::get_parameter(std::shared_ptr<Environment> &env,
       camera.max_depth = val.t_integer;
     } else if (name == "background") {
       camera.background = std::make_shared<PhysicalSky>(val.t_vector3);
+    } else if (name == "sky") {
+      camera.background = std::make_shared<AtmosphereSky>(val.t_vector3);
     } else if (name == "from") {
 
     } else if (name == "at") {
@@ -51,6 +54,23 @@ void Factory::get_parameter(std::shared_ptr<Environment> &env,
       }
     } else if (name == "camera") {
       camera = std::move(val.t_camera);
+    } else if (name == "ris") {
+      // 光源很多时改用重采样的直接光照，取值为每个着色点的光源候选数
+      camera.direct_lighting = DirectLighting::RIS;
+      camera.ris_candidates = val.t_integer;
+    } else if (name == "guiding") {
+      // 路径引导的训练轮数
+      camera.guiding_passes = val.t_integer;
+    } else if (name == "caustics") {
+      // 焦散光子图每轮发射的光子数
+      camera.caustic_photons = val.t_integer;
+    } else if (name == "caustic_radius") {
+      camera.caustic_radius = val.tag == BasicType::T_INT
+                                  ? static_cast<float>(val.t_integer)
+                                  : val.t_float;
+    } else if (name == "radiance_cache") {
+      // 从第几次弹射开始查询辐亮度缓存
+      camera.radiance_cache_depth = val.t_integer;
     }
   } catch (...) {
     std::cerr << "Not found variable '" + name + "'!" << std::endl;
@@ -59,15 +79,28 @@ void Factory::get_parameter(std::shared_ptr<Environment> &env,
 
 void Factory::create_scene(std::shared_ptr<Environment> &env) {
   std::vector<std::string> params = {
-      "image_shape", "spp", "depth", "background", "from",
-      "at",          "vup", "fov",   "world",      "camera"};
+      "image_shape", "spp",    "depth",    "background",    "sky",
+      "from",        "at",     "vup",      "fov",           "world",
+      "camera",      "ris",    "guiding",  "caustics",      "caustic_radius",
+      "radiance_cache"};
+  // 可选的设置在场景没有定义时保持默认值，不提示缺失；
+  // 仍按上面的顺序处理，与 camera 等设置的覆盖关系不变
+  static const std::unordered_set<std::string> optional = {
+      "sky", "ris", "guiding", "caustics", "caustic_radius", "radiance_cache"};
   for (const std::string &param : params) {
+    if (optional.count(param) && !env->has(param))
+      continue;
     get_parameter(env, param);
   }
 }
 
 void Factory::builder() {
   std::shared_ptr<Environment> global_env = std::make_shared<Environment>();
+  auto load_start = std::chrono::steady_clock::now();
+
+  // 模型之间互不依赖，先全部提交给资源流水线并行加载，求值到时再取结果
+  for (const auto &mesh : ast.meshes)
+    mesh->prefetch(global_env);
 
   for (const auto &[name, node] : ast.program) {
     try {
@@ -79,14 +112,56 @@ void Factory::builder() {
     }
   }
 
+  if (!ast.meshes.empty()) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - load_start;
+    printf("场景资源加载用时: %.3f s (%zu 个模型, %d 个加载线程)\n",
+           elapsed.count(), ast.meshes.size(),
+           utils::AssetPipeline::instance().workers());
+  }
+
   create_scene(global_env);
 
+  // 平行光没有包围盒，不参与求交：移出 world，由背景叠加其辐亮度
+  hittable_list scene;
+  bool has_sun = false;
   for (const auto &object : world.objects) {
+    if (auto sun = std::dynamic_pointer_cast<geometry::DistantLight>(object)) {
+      camera.background->add_sun(sun);
+      lights.add(sun);
+      has_sun = true;
+      continue;
+    }
+    scene.add(object);
+
     auto mat_ptr = object->get_material();
     if (mat_ptr && mat_ptr->is_emitter()) {
       lights.add(object);
+    } else if (auto emitters = object->light_source()) {
+      // 网格中 Ke / map_Ke 自发光的三角形
+      lights.add(emitters);
     }
   }
+  world = scene;
+
+  // 大气天空没有指定太阳时，按同一套散射参数补上经大气衰减的太阳
+  auto atmosphere = std::dynamic_pointer_cast<AtmosphereSky>(camera.background);
+  if (atmosphere && !has_sun) {
+    const float sun_angular_radius = 0.27f;
+    auto sun = std::make_shared<geometry::DistantLight>(
+        atmosphere->sun_direction(), sun_angular_radius,
+        atmosphere->sun_radiance(sun_angular_radius));
+    atmosphere->add_sun(sun);
+    lights.add(sun);
+  }
+
+  // HDR 贴图、天空查找表按亮度重要性采样，作为环境光参与直接光照
+  if (auto sky =
+          std::dynamic_pointer_cast<LatLongBackground>(camera.background)) {
+    auto env = std::make_shared<geometry::EnvironmentLight>(sky);
+    if (!env->empty())
+      lights.add(env);
+  }
 }
 
 } // namespace parser
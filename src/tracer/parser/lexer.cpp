@@ -24,6 +24,7 @@ Lexer::Lexer(const std::string &src) : source(src) {
   reserved["YZRect"] = TokenType::YZRectType;
   reserved["Box"] = TokenType::BoxType;
   reserved["Sphere"] = TokenType::SphereType;
+  reserved["Sun"] = TokenType::SunType;
   reserved["Heart"] = TokenType::HeartType;
   reserved["Ocean"] = TokenType::OceanType;
   reserved["Mesh"] = TokenType::MeshType;
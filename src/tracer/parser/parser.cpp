@@ -291,6 +291,17 @@ std::shared_ptr<ASTNode> Parser::parse_sphere() {
   return sphere;
 }
 
+std::shared_ptr<ASTNode> Parser::parse_sun() {
+  expect_token({TokenType::LeftParen});
+  std::shared_ptr<ASTNode> direction = parse_expression(Precedence::NONE);
+  std::shared_ptr<ASTNode> angle = parse_expression(Precedence::NONE);
+  std::shared_ptr<ASTNode> radiance = parse_expression(Precedence::NONE);
+  std::shared_ptr<SunNode> sun =
+      std::make_shared<SunNode>(direction, angle, radiance);
+  expect_token({TokenType::RightParen});
+  return sun;
+}
+
 std::shared_ptr<ASTNode> Parser::parse_heart() {
   expect_token({TokenType::LeftParen});
   std::shared_ptr<ASTNode> center = parse_expression(Precedence::NONE);
@@ -329,13 +340,17 @@ std::shared_ptr<ASTNode> Parser::parse_mesh() {
   expect_token({TokenType::LeftParen});
   std::shared_ptr<ASTNode> model_path = parse_expression(Precedence::NONE);
   std::shared_ptr<ASTNode> position = parse_expression(Precedence::NONE);
-  std::shared_ptr<MeshNode> mesh = nullptr;
+  std::shared_ptr<ASTNode> rot = nullptr;
+  std::shared_ptr<ASTNode> cull = nullptr;
   if (peek_token().type != TokenType::RightParen) {
-    std::shared_ptr<ASTNode> rot = parse_expression(Precedence::NONE);
-    mesh = std::make_shared<MeshNode>(model_path, position, rot);
-  } else {
-    mesh = std::make_shared<MeshNode>(model_path, position, nullptr);
+    rot = parse_expression(Precedence::NONE);
   }
+  if (peek_token().type != TokenType::RightParen) {
+    cull = parse_expression(Precedence::NONE);
+  }
+  std::shared_ptr<MeshNode> mesh =
+      std::make_shared<MeshNode>(model_path, position, rot, cull);
+  ast.meshes.push_back(mesh);
   expect_token({TokenType::RightParen});
   return mesh;
 }
@@ -532,6 +547,11 @@ std::shared_ptr<ASTNode> Parser::parse_expression(const Precedence &prec) {
     break;
   }
 
+  case TokenType::SunType: {
+    left = parse_sun();
+    break;
+  }
+
   case TokenType::HeartType: {
     left = parse_heart();
     break;
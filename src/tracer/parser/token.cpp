@@ -41,6 +41,8 @@ std::string to_string(TokenType type) {
     return "Box";
   case TokenType::SphereType:
     return "Sphere";
+  case TokenType::SunType:
+    return "Sun";
   case TokenType::HeartType:
     return "Heart";
   case TokenType::TranslateType:
@@ -0,0 +1,247 @@
+#include "tracer/texture/decoded_cache.h"
+#include "tracer/utils/cache_dir.h"
+#include "tracer/utils/content_hash.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace tracer {
+namespace texture {
+
+namespace fs = std::filesystem;
+
+// 格式或 MIP 生成方式改变时加一，旧的缓存文件随之失效
+static constexpr uint32_t DECODED_CACHE_VERSION = 1;
+static constexpr size_t SECTION_ALIGN = 64;
+static constexpr uint32_t MAX_LEVELS = 32;
+
+// 文件头之后是各层的宽高，补齐到 64 字节后依次为各层的像素，
+// 每层从 64 字节对齐的偏移开始
+struct DecodedHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint32_t kind;
+  uint32_t levels;
+  int32_t type; // Kind::Image 时为 OpenCV 的像素类型
+  uint32_t reserved;
+};
+
+#ifdef _WIN32
+static int process_id() { return _getpid(); }
+#else
+static int process_id() { return static_cast<int>(::getpid()); }
+#endif
+
+static size_t align_up(size_t bytes) {
+  return (bytes + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+static void pad(std::ofstream &out, size_t bytes) {
+  static const char zeros[SECTION_ALIGN] = {};
+  out.write(zeros, align_up(bytes) - bytes);
+}
+
+// 读取并校验文件头和各层尺寸，返回第一层像素的偏移，失败时返回 0
+static size_t read_header(const utils::MappedFile &file, uint64_t key,
+                          uint32_t kind, DecodedHeader &header,
+                          std::vector<uint32_t> &sizes) {
+  if (file.size() < sizeof(header))
+    return 0;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, "RTDC", 4) != 0 ||
+      header.version != DECODED_CACHE_VERSION || header.key != key ||
+      header.kind != kind || header.levels == 0 || header.levels > MAX_LEVELS)
+    return 0;
+  const size_t dims = sizeof(header) + header.levels * 2 * sizeof(uint32_t);
+  if (file.size() < align_up(dims))
+    return 0;
+  sizes.resize(header.levels * 2);
+  std::memcpy(sizes.data(), file.data() + sizeof(header),
+              sizes.size() * sizeof(uint32_t));
+  return align_up(dims);
+}
+
+// 先写临时文件再改名，多个进程同时写同一张图片时不会读到写了一半的文件
+template <class F>
+static void write_file(const std::string &file, const DecodedHeader &header,
+                       const std::vector<uint32_t> &sizes, F &&write_levels) {
+  std::error_code ec;
+  fs::create_directories(fs::path(file).parent_path(), ec);
+  static std::atomic<int> serial{0};
+  const std::string temp = file + ".tmp" + std::to_string(process_id()) +
+                           "_" + std::to_string(serial++);
+  {
+    std::ofstream out(temp, std::ios::binary);
+    if (!out)
+      return;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(sizes.data()),
+              sizes.size() * sizeof(uint32_t));
+    pad(out, sizeof(header) + sizes.size() * sizeof(uint32_t));
+    write_levels(out);
+    if (!out) {
+      out.close();
+      fs::remove(temp, ec);
+      return;
+    }
+  }
+  fs::rename(temp, file, ec);
+  if (ec)
+    fs::remove(temp, ec);
+}
+
+DecodedCache &DecodedCache::instance() {
+  static DecodedCache cache;
+  return cache;
+}
+
+DecodedCache::DecodedCache() : dir(utils::user_cache_dir("textures")) {}
+
+void DecodedCache::set_directory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(mutex);
+  dir = directory;
+}
+
+bool DecodedCache::enabled() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return !dir.empty();
+}
+
+std::string DecodedCache::cache_path(const std::string &source, Kind kind,
+                                     uint64_t &key) const {
+  std::string directory;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = dir;
+  }
+  if (directory.empty())
+    return "";
+  utils::MappedFile file(source);
+  if (file.empty())
+    return "";
+
+  const uint32_t layout[3] = {DECODED_CACHE_VERSION,
+                              static_cast<uint32_t>(kind),
+                              static_cast<uint32_t>(sizeof(DecodedHeader))};
+  key = utils::content_hash(layout, sizeof(layout),
+                            utils::content_hash(file.data(), file.size()));
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.rtc",
+           static_cast<unsigned long long>(key));
+  return (fs::path(directory) / name).string();
+}
+
+std::vector<TiledImage>
+DecodedCache::mip_chain(const std::string &path) const {
+  uint64_t key = 0;
+  const std::string file = cache_path(path, Kind::MipChain, key);
+  if (!file.empty()) {
+    auto mapped = std::make_shared<const utils::MappedFile>(file);
+    DecodedHeader header{};
+    std::vector<uint32_t> sizes;
+    size_t offset = read_header(*mapped, key,
+                                static_cast<uint32_t>(Kind::MipChain), header,
+                                sizes);
+    std::vector<TiledImage> chain;
+    for (uint32_t l = 0; offset != 0 && l < header.levels; ++l) {
+      const int w = static_cast<int>(sizes[2 * l]);
+      const int h = static_cast<int>(sizes[2 * l + 1]);
+      TiledImage level = TiledImage::mapped(mapped, offset, w, h);
+      if (level.empty())
+        break;
+      chain.push_back(std::move(level));
+      offset += align_up(TiledImage::bytes(w, h));
+    }
+    if (offset != 0 && chain.size() == header.levels)
+      return chain;
+  }
+
+  cv::Mat decoded = cv::imread(path, cv::IMREAD_COLOR);
+  if (decoded.empty())
+    return {};
+  std::vector<TiledImage> chain = TiledImage::mip_chain(decoded);
+  if (!file.empty()) {
+    DecodedHeader header = {{'R', 'T', 'D', 'C'},
+                            DECODED_CACHE_VERSION,
+                            key,
+                            static_cast<uint32_t>(Kind::MipChain),
+                            static_cast<uint32_t>(chain.size()),
+                            0,
+                            0};
+    std::vector<uint32_t> sizes;
+    for (const TiledImage &level : chain) {
+      sizes.push_back(static_cast<uint32_t>(level.width()));
+      sizes.push_back(static_cast<uint32_t>(level.height()));
+    }
+    write_file(file, header, sizes, [&](std::ofstream &out) {
+      for (const TiledImage &level : chain) {
+        out.write(static_cast<const char *>(level.data()), level.bytes());
+        pad(out, level.bytes());
+      }
+    });
+  }
+  return chain;
+}
+
+cv::Mat
+DecodedCache::image(const std::string &path,
+                    std::shared_ptr<const utils::MappedFile> &mapping) const {
+  mapping.reset();
+  uint64_t key = 0;
+  const std::string file = cache_path(path, Kind::Image, key);
+  if (!file.empty()) {
+    auto mapped = std::make_shared<const utils::MappedFile>(file);
+    DecodedHeader header{};
+    std::vector<uint32_t> sizes;
+    size_t offset = read_header(*mapped, key,
+                                static_cast<uint32_t>(Kind::Image), header,
+                                sizes);
+    // ImageBackground 只处理这两种像素类型，其他类型一律重新解码
+    if (offset != 0 && header.levels == 1 &&
+        (header.type == CV_8UC3 || header.type == CV_32FC3)) {
+      const int cols = static_cast<int>(sizes[0]);
+      const int rows = static_cast<int>(sizes[1]);
+      // 按行比较，宽高很大时乘积不会溢出
+      const size_t row = static_cast<size_t>(cols) * CV_ELEM_SIZE(header.type);
+      if (cols > 0 && rows > 0 &&
+          row <= (mapped->size() - offset) / static_cast<size_t>(rows)) {
+        // 映射是只读的，返回的 Mat 只用于读取
+        cv::Mat img(rows, cols, header.type,
+                    const_cast<char *>(mapped->data() + offset));
+        mapping = std::move(mapped);
+        return img;
+      }
+    }
+  }
+
+  cv::Mat img = cv::imread(path, cv::IMREAD_ANYDEPTH | cv::IMREAD_COLOR);
+  if (img.empty() || file.empty())
+    return img;
+  DecodedHeader header = {{'R', 'T', 'D', 'C'},
+                          DECODED_CACHE_VERSION,
+                          key,
+                          static_cast<uint32_t>(Kind::Image),
+                          1,
+                          img.type(),
+                          0};
+  std::vector<uint32_t> sizes = {static_cast<uint32_t>(img.cols),
+                                 static_cast<uint32_t>(img.rows)};
+  write_file(file, header, sizes, [&](std::ofstream &out) {
+    const size_t row = img.cols * img.elemSize();
+    for (int y = 0; y < img.rows; ++y)
+      out.write(img.ptr<char>(y), row);
+    pad(out, row * img.rows);
+  });
+  return img;
+}
+
+} // namespace texture
+} // namespace tracer
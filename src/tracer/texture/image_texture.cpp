@@ -1,55 +1,83 @@
 #include "tracer/texture/image_texture.h"
+#include "tracer/texture/decoded_cache.h"
 
 namespace tracer {
 namespace texture {
 
 ImageTexture::ImageTexture(const char *filepath) {
-  image = cv::imread(filepath, cv::IMREAD_COLOR);
-  if (image.empty()) {
+  std::vector<TiledImage> chain = DecodedCache::instance().mip_chain(filepath);
+  if (chain.empty()) {
     std::cerr << "无法加载纹理图片: " << filepath << "，切换至纯青色纹理。"
               << std::endl;
     width = 0;
     height = 0;
   } else {
-    width = image.cols - 1;
-    height = image.rows - 1;
-    std::cout << "成功加载纹理: " << filepath << " [" << width + 1 << "x" << height + 1
-              << "]" << std::endl;
+    width = chain[0].width() - 1;
+    height = chain[0].height() - 1;
+    std::cout << "成功加载纹理: " << filepath << " [" << width + 1 << "x"
+              << height + 1 << "]" << std::endl;
+    image = chain[0];
+    mips.assign(chain.begin() + 1, chain.end());
   }
 }
 
 Color ImageTexture::value(float u, float v, const Point3 &p) const {
   if (image.empty())
     return Color(0, 1, 1);
+  return image.bilinear(u, v);
+}
 
-  u = std::clamp(u, 0.0f, 1.0f);
-  v = 1.0f - std::clamp(v, 0.0f, 1.0f);
+Color ImageTexture::sample(float u, float v, const Point3 &p,
+                           float footprint) const {
+  if (image.empty())
+    return Color(0, 1, 1);
 
-  float uf = u * width;
-  float vf = v * height;
+  // 覆盖宽度折算成第 0 层的像素数，lod = log2(像素数)
+  float texels = footprint * static_cast<float>(std::max(width, height) + 1);
+  if (!(texels > 1.0f) || mips.empty())
+    return image.bilinear(u, v);
 
-  int i0 = static_cast<int>(uf);
-  int j0 = static_cast<int>(vf);
-  int i1 = std::min(i0 + 1, width);
-  int j1 = std::min(j0 + 1, height);
+  float lod = std::min(std::log2(texels), static_cast<float>(mips.size()));
+  int l0 = static_cast<int>(lod);
+  float t = lod - static_cast<float>(l0);
+  const TiledImage &fine = l0 == 0 ? image : mips[l0 - 1];
+  if (l0 >= static_cast<int>(mips.size()) || t <= 0.0f)
+    return fine.bilinear(u, v);
+  return (1.0f - t) * fine.bilinear(u, v) + t * mips[l0].bilinear(u, v);
+}
 
-  float du = uf - i0;
-  float dv = vf - j0;
+size_t ImageTexture::bytes() const {
+  size_t total = image.bytes();
+  for (const TiledImage &level : mips)
+    total += level.bytes();
+  return total;
+}
 
-  // 获取双线性插值后的颜色
-  auto get_pixel = [&](int x, int y) {
-    cv::Vec3b b = image.at<cv::Vec3b>(y, x);
-    return Color(b[2] / 255.0f, b[1] / 255.0f, b[0] / 255.0f);
-  };
+float ImageTexture::min_x_in_rect(float u0, float v0, float u1,
+                                  float v1) const {
+  if (image.empty())
+    return 0.0f;
 
-  Color c00 = get_pixel(i0, j0);
-  Color c10 = get_pixel(i1, j0);
-  Color c01 = get_pixel(i0, j1);
-  Color c11 = get_pixel(i1, j1);
+  // 与 value() 相同的坐标映射；双线性结果是覆盖像素的凸组合，
+  // 所以这些像素的最小值就是矩形内的下界
+  u0 = std::clamp(u0, 0.0f, 1.0f);
+  u1 = std::clamp(u1, 0.0f, 1.0f);
+  v0 = std::clamp(v0, 0.0f, 1.0f);
+  v1 = std::clamp(v1, 0.0f, 1.0f);
+  int i0 = static_cast<int>(u0 * width);
+  int i1 = std::min(static_cast<int>(std::ceil(u1 * width)), width);
+  int j0 = static_cast<int>((1.0f - v1) * height);
+  int j1 = std::min(static_cast<int>(std::ceil((1.0f - v0) * height)), height);
 
-  Color color = (1 - du) * (1 - dv) * c00 + du * (1 - dv) * c10 +
-                (1 - du) * dv * c01 + du * dv * c11;
-  return color;
+  float result = 1.0f;
+  for (int y = j0; y <= j1; ++y) {
+    for (int x = i0; x <= i1; ++x) {
+      float rgba[4];
+      image.fetch(x, y, rgba);
+      result = std::min(result, rgba[0]);
+    }
+  }
+  return result;
 }
 
 } // namespace texture
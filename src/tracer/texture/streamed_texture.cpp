@@ -0,0 +1,368 @@
+#include "tracer/texture/streamed_texture.h"
+#include "tracer/texture/decoded_cache.h"
+#include "tracer/texture/tiled_image.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#ifdef _WIN32
+#define NOMINMAX
+#include <process.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace tracer {
+namespace texture {
+
+namespace fs = std::filesystem;
+
+static constexpr uint32_t RTT_VERSION = 1;
+static constexpr size_t PAGE_TEXELS =
+    StreamedTexture::PAGE * StreamedTexture::PAGE;
+static constexpr size_t PAGE_BYTES = PAGE_TEXELS * sizeof(uint32_t);
+
+// 分页文件：文件头、各层的宽高，之后是逐层按行排列的页
+struct RttHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t page;
+  uint32_t levels;
+  uint64_t source_size;
+  int64_t source_time;
+};
+
+// 按偏移读取，不改变共享的文件位置，多个线程可以同时读同一个文件
+#ifdef _WIN32
+static intptr_t open_file(const std::string &path) {
+  HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  return h == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<intptr_t>(h);
+}
+
+static void close_file(intptr_t file) {
+  CloseHandle(reinterpret_cast<HANDLE>(file));
+}
+
+static bool read_at(intptr_t file, uint64_t offset, void *dst, size_t bytes) {
+  OVERLAPPED ov = {};
+  ov.Offset = static_cast<DWORD>(offset);
+  ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  DWORD read = 0;
+  return ReadFile(reinterpret_cast<HANDLE>(file), dst,
+                  static_cast<DWORD>(bytes), &read, &ov) &&
+         read == bytes;
+}
+
+static int process_id() { return _getpid(); }
+#else
+static intptr_t open_file(const std::string &path) {
+  return ::open(path.c_str(), O_RDONLY);
+}
+
+static void close_file(intptr_t file) { ::close(static_cast<int>(file)); }
+
+static bool read_at(intptr_t file, uint64_t offset, void *dst, size_t bytes) {
+  char *out = static_cast<char *>(dst);
+  while (bytes > 0) {
+    ssize_t n = ::pread(static_cast<int>(file), out, bytes,
+                        static_cast<off_t>(offset));
+    if (n <= 0)
+      return false;
+    out += n;
+    offset += static_cast<uint64_t>(n);
+    bytes -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+static int process_id() { return static_cast<int>(::getpid()); }
+#endif
+
+// 缓存目录中的文件名：源文件名加上完整路径的散列，不同目录的同名贴图不冲突
+static std::string tiled_name(const std::string &path) {
+  std::error_code ec;
+  fs::path canonical = fs::weakly_canonical(path, ec);
+  if (ec)
+    canonical = fs::path(path).lexically_normal();
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016llx",
+           static_cast<unsigned long long>(
+               std::hash<std::string>()(canonical.string())));
+  return canonical.stem().string() + "_" + hash + ".rtt";
+}
+
+// 解码源图片、生成 MIP 层并按页写出。先写临时文件再改名，
+// 多个进程同时转换同一张图片时不会读到写了一半的文件
+static bool write_pages(const std::string &source, const std::string &target,
+                        uint64_t source_size, int64_t source_time) {
+  std::vector<TiledImage> chain = DecodedCache::instance().mip_chain(source);
+  if (chain.empty())
+    return false;
+
+  // 同一进程中引用同一张图片的两个纹理可能同时生成分页文件，
+  // 临时文件名再加序号
+  static std::atomic<int> serial{0};
+  const std::string temp = target + ".tmp" + std::to_string(process_id()) +
+                           "_" + std::to_string(serial++);
+  std::error_code ec;
+  {
+    std::ofstream out(temp, std::ios::binary);
+    if (!out)
+      return false;
+
+    RttHeader header = {{'R', 'T', 'T', 'X'},
+                        RTT_VERSION,
+                        StreamedTexture::PAGE,
+                        static_cast<uint32_t>(chain.size()),
+                        source_size,
+                        source_time};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const TiledImage &level : chain) {
+      uint32_t size[2] = {static_cast<uint32_t>(level.width()),
+                          static_cast<uint32_t>(level.height())};
+      out.write(reinterpret_cast<const char *>(size), sizeof(size));
+    }
+
+    const int P = StreamedTexture::PAGE;
+    std::vector<uint32_t> page(PAGE_TEXELS);
+    for (const TiledImage &level : chain) {
+      const int w = level.width(), h = level.height();
+      for (int py = 0; py < (h + P - 1) / P; ++py) {
+        for (int px = 0; px < (w + P - 1) / P; ++px) {
+          // 越过图像边缘的部分重复边缘像素
+          for (int y = 0; y < P; ++y) {
+            const int sy = std::min(py * P + y, h - 1);
+            for (int x = 0; x < P; ++x)
+              page[y * P + x] = level.packed(std::min(px * P + x, w - 1), sy);
+          }
+          out.write(reinterpret_cast<const char *>(page.data()), PAGE_BYTES);
+        }
+      }
+    }
+    if (!out) {
+      out.close();
+      fs::remove(temp, ec);
+      return false;
+    }
+  }
+
+  fs::rename(temp, target, ec);
+  if (ec) {
+    fs::remove(temp, ec);
+    return fs::exists(target, ec);
+  }
+  return true;
+}
+
+StreamedTexture::StreamedTexture(const std::string &filepath,
+                                 const std::string &cache_dir)
+    : path(filepath), id(TileCache::instance().register_texture()) {
+  std::error_code ec;
+  uint64_t source_size = fs::file_size(filepath, ec);
+  int64_t source_time = 0;
+  if (!ec) {
+    source_time = static_cast<int64_t>(
+        fs::last_write_time(filepath, ec).time_since_epoch().count());
+  }
+  if (ec)
+    return;
+
+  fs::create_directories(cache_dir, ec);
+  const std::string tiled =
+      (fs::path(cache_dir) / tiled_name(filepath)).string();
+  if (!open_pages(tiled, source_size, source_time)) {
+    if (!write_pages(filepath, tiled, source_size, source_time) ||
+        !open_pages(tiled, source_size, source_time)) {
+      std::cerr << "无法生成分页纹理: " << tiled << std::endl;
+      return;
+    }
+    std::cout << "已生成分页纹理: " << tiled << std::endl;
+  }
+  std::cout << "按需加载纹理: " << filepath << " [" << levels[0].width << "x"
+            << levels[0].height << "]" << std::endl;
+}
+
+StreamedTexture::~StreamedTexture() {
+  if (file != -1)
+    close_file(file);
+}
+
+bool StreamedTexture::open_pages(const std::string &tiled_path,
+                                 uint64_t source_size, int64_t source_time) {
+  file = open_file(tiled_path);
+  if (file == -1)
+    return false;
+
+  RttHeader header;
+  bool valid = read_at(file, 0, &header, sizeof(header)) &&
+               std::equal(header.magic, header.magic + 4, "RTTX") &&
+               header.version == RTT_VERSION && header.page == PAGE &&
+               header.levels > 0 && header.levels <= 32 &&
+               header.source_size == source_size &&
+               header.source_time == source_time;
+
+  std::vector<uint32_t> sizes(valid ? 2 * header.levels : 0);
+  if (valid)
+    valid = read_at(file, sizeof(header), sizes.data(),
+                    sizes.size() * sizeof(uint32_t));
+
+  // 各层尺寸必须与 TiledImage::mip_chain 的结果一致：第一层不为空，
+  // 之后每层减半（至少为 1），最后一层为 1x1；文件大小必须正好容纳
+  // 全部的页。不一致说明文件损坏或被截断，按未命中处理并重新生成
+  std::vector<Level> table;
+  uint64_t first_page = 0;
+  for (uint32_t l = 0; valid && l < header.levels; ++l) {
+    const uint32_t w = sizes[2 * l], h = sizes[2 * l + 1];
+    if (l == 0) {
+      valid = w > 0 && h > 0 && w <= (1u << 24) && h <= (1u << 24);
+    } else {
+      valid = w == static_cast<uint32_t>(std::max(1, table.back().width / 2)) &&
+              h == static_cast<uint32_t>(std::max(1, table.back().height / 2));
+    }
+    if (!valid)
+      break;
+    Level level;
+    level.width = static_cast<int>(w);
+    level.height = static_cast<int>(h);
+    level.pages_x = (level.width + PAGE - 1) / PAGE;
+    level.first_page = static_cast<uint32_t>(first_page);
+    first_page += static_cast<uint64_t>(level.pages_x) *
+                  ((level.height + PAGE - 1) / PAGE);
+    valid = first_page <= std::numeric_limits<uint32_t>::max();
+    table.push_back(level);
+  }
+  const uint64_t offset = sizeof(header) + sizes.size() * sizeof(uint32_t);
+  if (valid) {
+    std::error_code ec;
+    const uint64_t size = fs::file_size(tiled_path, ec);
+    valid = !ec && table.back().width == 1 && table.back().height == 1 &&
+            size == offset + first_page * PAGE_BYTES;
+  }
+  if (!valid) {
+    close_file(file);
+    file = -1;
+    return false;
+  }
+
+  levels = std::move(table);
+  data_offset = offset;
+  return true;
+}
+
+TileCache::PagePtr StreamedTexture::page(uint32_t index) const {
+  const uint64_t key = (static_cast<uint64_t>(id) << 32) | index;
+  return TileCache::instance().get(key, [this, index]() {
+    auto page = std::make_shared<TileCache::Page>(PAGE_TEXELS);
+    if (!read_at(file, data_offset + index * PAGE_BYTES, page->data(),
+                 PAGE_BYTES)) {
+      // 文件被截断或删除时退回纯青色，与加载失败的纹理一致
+      std::fill(page->begin(), page->end(), 0xffffff00u);
+    }
+    return TileCache::PagePtr(std::move(page));
+  });
+}
+
+uint32_t StreamedTexture::texel(const Level &level, int x, int y) const {
+  uint32_t index = level.first_page + (y / PAGE) * level.pages_x + x / PAGE;
+  return (*page(index))[(y % PAGE) * PAGE + x % PAGE];
+}
+
+Color StreamedTexture::bilinear(const Level &level, float u, float v) const {
+  const int wmax = level.width - 1;
+  const int hmax = level.height - 1;
+
+  u = std::clamp(u, 0.0f, 1.0f);
+  v = 1.0f - std::clamp(v, 0.0f, 1.0f);
+
+  float uf = u * wmax;
+  float vf = v * hmax;
+
+  int i0 = static_cast<int>(uf);
+  int j0 = static_cast<int>(vf);
+  int i1 = std::min(i0 + 1, wmax);
+  int j1 = std::min(j0 + 1, hmax);
+
+  float du = uf - i0;
+  float dv = vf - j0;
+
+  uint32_t texels[4];
+  if (i0 / PAGE == i1 / PAGE && j0 / PAGE == j1 / PAGE) {
+    // 四个像素在同一页内（绝大多数情况），只查一次缓存
+    TileCache::PagePtr p = page(level.first_page +
+                                (j0 / PAGE) * level.pages_x + i0 / PAGE);
+    const uint32_t *row0 = p->data() + (j0 % PAGE) * PAGE;
+    const uint32_t *row1 = p->data() + (j1 % PAGE) * PAGE;
+    texels[0] = row0[i0 % PAGE];
+    texels[1] = row0[i1 % PAGE];
+    texels[2] = row1[i0 % PAGE];
+    texels[3] = row1[i1 % PAGE];
+  } else {
+    texels[0] = texel(level, i0, j0);
+    texels[1] = texel(level, i1, j0);
+    texels[2] = texel(level, i0, j1);
+    texels[3] = texel(level, i1, j1);
+  }
+  return TiledImage::bilerp(texels, du, dv);
+}
+
+Color StreamedTexture::value(float u, float v, const Point3 &p) const {
+  if (levels.empty())
+    return Color(0, 1, 1);
+  return bilinear(levels[0], u, v);
+}
+
+Color StreamedTexture::sample(float u, float v, const Point3 &p,
+                              float footprint) const {
+  if (levels.empty())
+    return Color(0, 1, 1);
+
+  // 与 ImageTexture::sample 相同的层级选择
+  const int last = static_cast<int>(levels.size()) - 1;
+  float texels = footprint * static_cast<float>(
+                                 std::max(levels[0].width, levels[0].height));
+  if (!(texels > 1.0f) || last == 0)
+    return bilinear(levels[0], u, v);
+
+  float lod = std::min(std::log2(texels), static_cast<float>(last));
+  int l0 = static_cast<int>(lod);
+  float t = lod - static_cast<float>(l0);
+  if (l0 >= last || t <= 0.0f)
+    return bilinear(levels[l0], u, v);
+  return (1.0f - t) * bilinear(levels[l0], u, v) +
+         t * bilinear(levels[l0 + 1], u, v);
+}
+
+float StreamedTexture::min_x_in_rect(float u0, float v0, float u1,
+                                     float v1) const {
+  if (levels.empty())
+    return 0.0f;
+
+  const Level &level = levels[0];
+  const int width = level.width - 1;
+  const int height = level.height - 1;
+  u0 = std::clamp(u0, 0.0f, 1.0f);
+  u1 = std::clamp(u1, 0.0f, 1.0f);
+  v0 = std::clamp(v0, 0.0f, 1.0f);
+  v1 = std::clamp(v1, 0.0f, 1.0f);
+  int i0 = static_cast<int>(u0 * width);
+  int i1 = std::min(static_cast<int>(std::ceil(u1 * width)), width);
+  int j0 = static_cast<int>((1.0f - v1) * height);
+  int j1 = std::min(static_cast<int>(std::ceil((1.0f - v0) * height)), height);
+
+  float result = 1.0f;
+  for (int y = j0; y <= j1; ++y) {
+    for (int x = i0; x <= i1; ++x) {
+      float rgba[4];
+      TiledImage::unpack(texel(level, x, y), rgba);
+      result = std::min(result, rgba[0]);
+    }
+  }
+  return result;
+}
+
+} // namespace texture
+} // namespace tracer
@@ -0,0 +1,124 @@
+#include "tracer/texture/texture_cache.h"
+#include "tracer/utils/cache_dir.h"
+#include <filesystem>
+#include <iostream>
+
+namespace tracer {
+namespace texture {
+
+TextureCache &TextureCache::instance() {
+  static TextureCache cache;
+  return cache;
+}
+
+// "dir/./a.png" 与 "dir/a.png" 指向同一个文件，统一成规范形式作为键
+static std::string cache_key(const std::string &path) {
+  std::error_code ec;
+  std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+  if (ec)
+    return std::filesystem::path(path).lexically_normal().string();
+  return p.string();
+}
+
+std::shared_ptr<Texture> TextureCache::load(const std::string &path) {
+  const std::string key = cache_key(path);
+
+  std::promise<std::shared_ptr<Texture>> promise;
+  Handle handle;
+  bool owner = false;
+  bool stream = false;
+  std::string dir;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++requests;
+    stream = streaming;
+    dir = tile_dir;
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+      handle = it->second;
+    } else {
+      handle = promise.get_future().share();
+      textures.emplace(key, handle);
+      owner = true;
+    }
+  }
+
+  // 解码在锁外进行；加载失败的纹理同样缓存，错误信息只打印一次
+  if (owner) {
+    std::shared_ptr<Texture> texture;
+    if (stream) {
+      auto streamed = std::make_shared<StreamedTexture>(path, dir);
+      if (!streamed->empty())
+        texture = std::move(streamed);
+    }
+    // 分页文件写不出来（目录只读、磁盘已满）时退回整张加载；
+    // 源图片本身无法解码时由 ImageTexture 给出提示并使用纯青色
+    if (!texture)
+      texture = std::make_shared<ImageTexture>(path.c_str());
+    promise.set_value(std::move(texture));
+  }
+  return handle.get();
+}
+
+void TextureCache::enable_streaming(size_t budget,
+                                    const std::string &cache_dir) {
+  const std::string dir =
+      cache_dir.empty() ? utils::user_cache_dir("tiles") : cache_dir;
+  if (dir.empty()) {
+    std::cerr << "没有可用的分页文件目录，纹理仍整张加载" << std::endl;
+    return;
+  }
+  TileCache::instance().set_budget(budget);
+  std::lock_guard<std::mutex> lock(mutex);
+  streaming = true;
+  tile_dir = dir;
+}
+
+size_t TextureCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return textures.size();
+}
+
+size_t TextureCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t total = 0;
+  for (const auto &entry : textures) {
+    // 还在其它线程中解码的纹理不计入，按需加载的纹理由分页缓存统计
+    if (entry.second.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready)
+      continue;
+    auto image = std::dynamic_pointer_cast<ImageTexture>(entry.second.get());
+    if (image)
+      total += image->bytes();
+  }
+  return total;
+}
+
+void TextureCache::report() const {
+  size_t count = size();
+  size_t total = bytes();
+  size_t hits;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    hits = requests - count;
+  }
+  printf("纹理缓存: %zu 张图片, %.1f MB, 重复引用 %zu 次\n", count,
+         total / (1024.0 * 1024.0), hits);
+
+  bool stream;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stream = streaming;
+  }
+  if (stream)
+    TileCache::instance().report();
+}
+
+void TextureCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  textures.clear();
+  requests = 0;
+}
+
+} // namespace texture
+} // namespace tracer
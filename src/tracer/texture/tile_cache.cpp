@@ -0,0 +1,129 @@
+#include "tracer/texture/tile_cache.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace tracer {
+namespace texture {
+
+// 每个线程最近用过的页，直接映射
+static constexpr int LOCAL_SLOTS = 64;
+// 线程本地命中先在本地计数，攒够再合并到全局，避免每次查询都写原子量
+static constexpr uint32_t LOCAL_FLUSH = 1024;
+
+struct LocalPages {
+  uint64_t key[LOCAL_SLOTS] = {};
+  TileCache::PagePtr page[LOCAL_SLOTS];
+  uint32_t pending_hits = 0;
+};
+
+static size_t mix(uint64_t key) {
+  key ^= key >> 29;
+  key *= 0xbf58476d1ce4e5b9ull;
+  key ^= key >> 32;
+  return static_cast<size_t>(key);
+}
+
+static size_t page_bytes(const TileCache::Page &page) {
+  return page.size() * sizeof(uint32_t);
+}
+
+TileCache &TileCache::instance() {
+  static TileCache cache;
+  return cache;
+}
+
+TileCache::TileCache() : shards(SHARDS), budget_bytes(size_t(512) << 20) {}
+
+uint32_t TileCache::register_texture() { return next_texture++; }
+
+void TileCache::set_budget(size_t bytes) { budget_bytes = bytes; }
+
+TileCache::PagePtr TileCache::get(uint64_t key,
+                                  const std::function<PagePtr()> &load) {
+  thread_local LocalPages local;
+  const size_t h = mix(key);
+  const int slot = static_cast<int>(h % LOCAL_SLOTS);
+  if (local.key[slot] == key) {
+    if (++local.pending_hits == LOCAL_FLUSH) {
+      local_hits += LOCAL_FLUSH;
+      local.pending_hits = 0;
+    }
+    return local.page[slot];
+  }
+
+  Shard &shard = shards[(h >> 8) % SHARDS];
+  PagePtr page;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      page = it->second->page;
+    }
+  }
+
+  if (page) {
+    ++shared_hits;
+  } else {
+    ++misses;
+    PagePtr loaded = load();
+    const size_t bytes = page_bytes(*loaded);
+    // 每个分片至少能放下一页
+    const size_t shard_budget =
+        std::max(budget_bytes.load() / SHARDS, bytes);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      // 读盘期间另一个线程已经插入了这一页
+      ++duplicate_reads;
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      page = it->second->page;
+    } else {
+      page = loaded;
+      shard.lru.push_front(Entry{key, page});
+      shard.index.emplace(key, shard.lru.begin());
+      shard.bytes += bytes;
+      size_t now = resident += bytes;
+      while (shard.bytes > shard_budget && shard.lru.size() > 1) {
+        const Entry &victim = shard.lru.back();
+        const size_t freed = page_bytes(*victim.page);
+        shard.bytes -= freed;
+        now = resident -= freed;
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+        ++evictions;
+      }
+      size_t seen = peak.load();
+      while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+      }
+    }
+  }
+
+  local.key[slot] = key;
+  local.page[slot] = page;
+  return page;
+}
+
+void TileCache::report() const {
+  const uint64_t local = local_hits.load();
+  const uint64_t shared = shared_hits.load();
+  const uint64_t miss = misses.load();
+  const uint64_t total = local + shared + miss;
+  printf("纹理分页缓存: 查询 %llu 次, 线程本地命中 %llu, 共享命中 %llu, "
+         "缺页 %llu (重复读取 %llu), 淘汰 %llu 页\n",
+         static_cast<unsigned long long>(total),
+         static_cast<unsigned long long>(local),
+         static_cast<unsigned long long>(shared),
+         static_cast<unsigned long long>(miss),
+         static_cast<unsigned long long>(duplicate_reads.load()),
+         static_cast<unsigned long long>(evictions.load()));
+  printf("纹理分页缓存: 命中率 %.2f%%, 常驻 %.1f MB, 峰值 %.1f MB, "
+         "预算 %.1f MB\n",
+         total ? 100.0 * (local + shared) / total : 0.0,
+         resident.load() / (1024.0 * 1024.0), peak.load() / (1024.0 * 1024.0),
+         budget_bytes.load() / (1024.0 * 1024.0));
+}
+
+} // namespace texture
+} // namespace tracer
@@ -0,0 +1,142 @@
+#include "tracer/texture/tiled_image.h"
+#include <algorithm>
+#include <immintrin.h>
+
+namespace tracer {
+namespace texture {
+
+static uint32_t pack_rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+  return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// 一个像素的 4 个 8 位分量展开成 4 个 float，取值 [0, 255]
+static __m128 unpack_rgba(uint32_t bits) {
+  __m128i v = _mm_cvtsi32_si128(static_cast<int>(bits));
+#ifdef __SSE4_1__
+  v = _mm_cvtepu8_epi32(v);
+#else
+  const __m128i zero = _mm_setzero_si128();
+  v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+#endif
+  return _mm_cvtepi32_ps(v);
+}
+
+TiledImage::TiledImage(int w, int h)
+    : w(w), h(h), tiles_x((w + TILE - 1) / TILE),
+      tile_count(static_cast<size_t>(tiles_x) * ((h + TILE - 1) / TILE)),
+      storage(std::make_shared<std::vector<Tile>>(tile_count)) {
+  tiles = storage->data();
+}
+
+size_t TiledImage::bytes(int w, int h) {
+  return static_cast<size_t>((w + TILE - 1) / TILE) * ((h + TILE - 1) / TILE) *
+         sizeof(Tile);
+}
+
+TiledImage TiledImage::mapped(std::shared_ptr<const utils::MappedFile> file,
+                              size_t offset, int w, int h) {
+  TiledImage out;
+  if (w <= 0 || h <= 0 || offset % alignof(Tile) != 0 ||
+      offset + bytes(w, h) > file->size())
+    return out;
+  out.w = w;
+  out.h = h;
+  out.tiles_x = (w + TILE - 1) / TILE;
+  out.tile_count = bytes(w, h) / sizeof(Tile);
+  out.tiles = reinterpret_cast<const Tile *>(file->data() + offset);
+  out.mapping = std::move(file);
+  return out;
+}
+
+TiledImage::TiledImage(const cv::Mat &bgr) : TiledImage(bgr.cols, bgr.rows) {
+#pragma omp parallel for
+  for (int y = 0; y < h; ++y) {
+    const cv::Vec3b *row = bgr.ptr<cv::Vec3b>(y);
+    for (int x = 0; x < w; ++x)
+      texel(x, y) = pack_rgba(row[x][2], row[x][1], row[x][0], 255);
+  }
+}
+
+TiledImage TiledImage::downsample() const {
+  TiledImage out(std::max(1, w / 2), std::max(1, h / 2));
+#pragma omp parallel for
+  for (int y = 0; y < out.h; ++y) {
+    const int y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+    for (int x = 0; x < out.w; ++x) {
+      const int x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+      const uint32_t p[4] = {texel(x0, y0), texel(x1, y0), texel(x0, y1),
+                             texel(x1, y1)};
+      uint32_t avg[4];
+      for (int c = 0; c < 4; ++c) {
+        uint32_t sum = 2; // 四舍五入
+        for (int k = 0; k < 4; ++k)
+          sum += (p[k] >> (8 * c)) & 0xff;
+        avg[c] = sum / 4;
+      }
+      out.texel(x, y) = pack_rgba(avg[0], avg[1], avg[2], avg[3]);
+    }
+  }
+  return out;
+}
+
+std::vector<TiledImage> TiledImage::mip_chain(const cv::Mat &bgr) {
+  std::vector<TiledImage> chain;
+  chain.emplace_back(bgr);
+  while (chain.back().width() > 1 || chain.back().height() > 1)
+    chain.push_back(chain.back().downsample());
+  return chain;
+}
+
+Color TiledImage::bilinear(float u, float v) const {
+  const int wmax = w - 1;
+  const int hmax = h - 1;
+
+  u = std::clamp(u, 0.0f, 1.0f);
+  v = 1.0f - std::clamp(v, 0.0f, 1.0f);
+
+  float uf = u * wmax;
+  float vf = v * hmax;
+
+  int i0 = static_cast<int>(uf);
+  int j0 = static_cast<int>(vf);
+  int i1 = std::min(i0 + 1, wmax);
+  int j1 = std::min(j0 + 1, hmax);
+
+  float du = uf - i0;
+  float dv = vf - j0;
+
+  const uint32_t texels[4] = {texel(i0, j0), texel(i1, j0), texel(i0, j1),
+                              texel(i1, j1)};
+  return bilerp(texels, du, dv);
+}
+
+Color TiledImage::bilerp(const uint32_t texels[4], float du, float dv) {
+  __m128 c00 = unpack_rgba(texels[0]);
+  __m128 c10 = unpack_rgba(texels[1]);
+  __m128 c01 = unpack_rgba(texels[2]);
+  __m128 c11 = unpack_rgba(texels[3]);
+
+  const __m128 fu = _mm_set1_ps(du);
+  const __m128 fv = _mm_set1_ps(dv);
+  __m128 top = _mm_add_ps(c00, _mm_mul_ps(fu, _mm_sub_ps(c10, c00)));
+  __m128 bottom = _mm_add_ps(c01, _mm_mul_ps(fu, _mm_sub_ps(c11, c01)));
+  __m128 c = _mm_add_ps(top, _mm_mul_ps(fv, _mm_sub_ps(bottom, top)));
+  // 归一化放在插值之后，只需一次乘法
+  c = _mm_mul_ps(c, _mm_set1_ps(1.0f / 255.0f));
+
+  alignas(16) float out[4];
+  _mm_store_ps(out, c);
+  return Color(out[0], out[1], out[2]);
+}
+
+void TiledImage::fetch(int x, int y, float rgba[4]) const {
+  unpack(texel(x, y), rgba);
+}
+
+void TiledImage::unpack(uint32_t texel, float rgba[4]) {
+  _mm_storeu_ps(rgba,
+                _mm_mul_ps(unpack_rgba(texel), _mm_set1_ps(1.0f / 255.0f)));
+}
+
+} // namespace texture
+} // namespace tracer
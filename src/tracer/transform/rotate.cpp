@@ -3,6 +3,23 @@
 namespace tracer {
 namespace transform {
 
+// 绕某一坐标轴旋转时只改变 (a, b) 两个分量，与 hit 中光线/交点的变换一致
+static Vec3 rotate_to_local(const Vec3 &v, int a, int b, float sin_theta,
+                            float cos_theta) {
+  Vec3 r = v;
+  r[a] = cos_theta * v[a] - sin_theta * v[b];
+  r[b] = sin_theta * v[a] + cos_theta * v[b];
+  return r;
+}
+
+static Vec3 rotate_to_world(const Vec3 &v, int a, int b, float sin_theta,
+                            float cos_theta) {
+  Vec3 r = v;
+  r[a] = cos_theta * v[a] + sin_theta * v[b];
+  r[b] = -sin_theta * v[a] + cos_theta * v[b];
+  return r;
+}
+
 RotateX::RotateX(std::shared_ptr<hittable> p, float angle) : ptr(p) {
   float radians = angle * tracer::math::TRACER_PI / 180.f;
   sin_theta = std::sin(radians);
@@ -180,5 +197,134 @@ bool RotateZ::hit(const Ray &r, float t_min, float t_max,
   return true;
 }
 
+float RotateX::pdf_value(const Point3 &o, const Vec3 &v) const {
+  return ptr->pdf_value(rotate_to_local(o, 1, 2, sin_theta, cos_theta),
+                        rotate_to_local(v, 1, 2, sin_theta, cos_theta));
+}
+
+Vec3 RotateX::random(const Point3 &o) const {
+  Vec3 p = ptr->random(rotate_to_local(o, 1, 2, sin_theta, cos_theta));
+  return rotate_to_world(p, 1, 2, sin_theta, cos_theta);
+}
+
+float RotateX::light_pdf(const Point3 &o, const Vec3 &v,
+                         const hit_record &rec) const {
+  hit_record local = rec;
+  local.p = rotate_to_local(rec.p, 1, 2, sin_theta, cos_theta);
+  return ptr->light_pdf(rotate_to_local(o, 1, 2, sin_theta, cos_theta),
+                        rotate_to_local(v, 1, 2, sin_theta, cos_theta),
+                        local);
+}
+
+std::shared_ptr<hittable> RotateX::light_source() const {
+  auto inner = ptr->light_source();
+  if (!inner)
+    return nullptr;
+  float angle = std::atan2(sin_theta, cos_theta) * 180.f / math::TRACER_PI;
+  return std::make_shared<RotateX>(inner, angle);
+}
+
+bool RotateX::emission_cone(Vec3 &axis, float &cos_theta_o) const {
+  if (!ptr->emission_cone(axis, cos_theta_o))
+    return false;
+  axis = rotate_to_world(axis, 1, 2, sin_theta, cos_theta);
+  return true;
+}
+
+float RotateX::sample_surface(hit_record &rec) const {
+  float pdf = ptr->sample_surface(rec);
+  rec.p = rotate_to_world(rec.p, 1, 2, sin_theta, cos_theta);
+  rec.normal = rotate_to_world(rec.normal, 1, 2, sin_theta, cos_theta);
+  rec.tangent = rotate_to_world(rec.tangent, 1, 2, sin_theta, cos_theta);
+  rec.bitangent = rotate_to_world(rec.bitangent, 1, 2, sin_theta, cos_theta);
+  return pdf;
+}
+
+float RotateY::pdf_value(const Point3 &o, const Vec3 &v) const {
+  return ptr->pdf_value(rotate_to_local(o, 0, 2, sin_theta, cos_theta),
+                        rotate_to_local(v, 0, 2, sin_theta, cos_theta));
+}
+
+Vec3 RotateY::random(const Point3 &o) const {
+  Vec3 p = ptr->random(rotate_to_local(o, 0, 2, sin_theta, cos_theta));
+  return rotate_to_world(p, 0, 2, sin_theta, cos_theta);
+}
+
+float RotateY::light_pdf(const Point3 &o, const Vec3 &v,
+                         const hit_record &rec) const {
+  hit_record local = rec;
+  local.p = rotate_to_local(rec.p, 0, 2, sin_theta, cos_theta);
+  return ptr->light_pdf(rotate_to_local(o, 0, 2, sin_theta, cos_theta),
+                        rotate_to_local(v, 0, 2, sin_theta, cos_theta),
+                        local);
+}
+
+std::shared_ptr<hittable> RotateY::light_source() const {
+  auto inner = ptr->light_source();
+  if (!inner)
+    return nullptr;
+  float angle = std::atan2(sin_theta, cos_theta) * 180.f / math::TRACER_PI;
+  return std::make_shared<RotateY>(inner, angle);
+}
+
+bool RotateY::emission_cone(Vec3 &axis, float &cos_theta_o) const {
+  if (!ptr->emission_cone(axis, cos_theta_o))
+    return false;
+  axis = rotate_to_world(axis, 0, 2, sin_theta, cos_theta);
+  return true;
+}
+
+float RotateY::sample_surface(hit_record &rec) const {
+  float pdf = ptr->sample_surface(rec);
+  rec.p = rotate_to_world(rec.p, 0, 2, sin_theta, cos_theta);
+  rec.normal = rotate_to_world(rec.normal, 0, 2, sin_theta, cos_theta);
+  rec.tangent = rotate_to_world(rec.tangent, 0, 2, sin_theta, cos_theta);
+  rec.bitangent = rotate_to_world(rec.bitangent, 0, 2, sin_theta, cos_theta);
+  return pdf;
+}
+
+float RotateZ::pdf_value(const Point3 &o, const Vec3 &v) const {
+  return ptr->pdf_value(rotate_to_local(o, 0, 1, sin_theta, cos_theta),
+                        rotate_to_local(v, 0, 1, sin_theta, cos_theta));
+}
+
+Vec3 RotateZ::random(const Point3 &o) const {
+  Vec3 p = ptr->random(rotate_to_local(o, 0, 1, sin_theta, cos_theta));
+  return rotate_to_world(p, 0, 1, sin_theta, cos_theta);
+}
+
+float RotateZ::light_pdf(const Point3 &o, const Vec3 &v,
+                         const hit_record &rec) const {
+  hit_record local = rec;
+  local.p = rotate_to_local(rec.p, 0, 1, sin_theta, cos_theta);
+  return ptr->light_pdf(rotate_to_local(o, 0, 1, sin_theta, cos_theta),
+                        rotate_to_local(v, 0, 1, sin_theta, cos_theta),
+                        local);
+}
+
+std::shared_ptr<hittable> RotateZ::light_source() const {
+  auto inner = ptr->light_source();
+  if (!inner)
+    return nullptr;
+  float angle = std::atan2(sin_theta, cos_theta) * 180.f / math::TRACER_PI;
+  return std::make_shared<RotateZ>(inner, angle);
+}
+
+bool RotateZ::emission_cone(Vec3 &axis, float &cos_theta_o) const {
+  if (!ptr->emission_cone(axis, cos_theta_o))
+    return false;
+  axis = rotate_to_world(axis, 0, 1, sin_theta, cos_theta);
+  return true;
+}
+
+float RotateZ::sample_surface(hit_record &rec) const {
+  float pdf = ptr->sample_surface(rec);
+  rec.p = rotate_to_world(rec.p, 0, 1, sin_theta, cos_theta);
+  rec.normal = rotate_to_world(rec.normal, 0, 1, sin_theta, cos_theta);
+  rec.tangent = rotate_to_world(rec.tangent, 0, 1, sin_theta, cos_theta);
+  rec.bitangent = rotate_to_world(rec.bitangent, 0, 1, sin_theta, cos_theta);
+  return pdf;
+}
+
 } // namespace geometry
 } // namespace tracer
\ No newline at end of file
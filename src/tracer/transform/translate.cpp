@@ -20,5 +20,37 @@ bool Translate::bounding_box(float t0, float t1, AABB &output_box) const {
   return true;
 }
 
+float Translate::pdf_value(const Point3 &o, const Vec3 &v) const {
+  return ptr->pdf_value(o - offset, v);
+}
+
+Vec3 Translate::random(const Point3 &o) const {
+  return ptr->random(o - offset) + offset;
+}
+
+float Translate::light_pdf(const Point3 &o, const Vec3 &v,
+                           const hit_record &rec) const {
+  hit_record local = rec;
+  local.p -= offset;
+  return ptr->light_pdf(o - offset, v, local);
+}
+
+std::shared_ptr<hittable> Translate::light_source() const {
+  auto inner = ptr->light_source();
+  if (!inner)
+    return nullptr;
+  return std::make_shared<Translate>(inner, offset);
+}
+
+bool Translate::emission_cone(Vec3 &axis, float &cos_theta_o) const {
+  return ptr->emission_cone(axis, cos_theta_o);
+}
+
+float Translate::sample_surface(hit_record &rec) const {
+  float pdf = ptr->sample_surface(rec);
+  rec.p += offset;
+  return pdf;
+}
+
 } // namespace transform
 } // namespace tracer
\ No newline at end of file
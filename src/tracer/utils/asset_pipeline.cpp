@@ -0,0 +1,117 @@
+#include "tracer/utils/asset_pipeline.h"
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace tracer {
+namespace utils {
+
+AssetPipeline &AssetPipeline::instance() {
+  static AssetPipeline pipeline;
+  return pipeline;
+}
+
+AssetPipeline::AssetPipeline() {
+#ifdef _OPENMP
+  omp_threads = omp_get_max_threads();
+#endif
+  // 加载以读盘和解码为主，单核机器上也保留两个线程让读盘与计算重叠
+  const int count =
+      std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+  for (int i = 0; i < count; ++i)
+    threads.emplace_back([this]() { worker(); });
+}
+
+AssetPipeline::~AssetPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  ready.notify_all();
+  for (std::thread &t : threads)
+    t.join();
+}
+
+void AssetPipeline::schedule(const std::shared_ptr<Node> &node,
+                             const std::vector<std::shared_ptr<Node>> &deps) {
+  // pending 初始为 1，登记完全部依赖后再减掉，避免依赖在登记途中完成
+  // 时提前入队
+  for (const auto &dep : deps) {
+    if (!dep)
+      continue;
+    std::lock_guard<std::mutex> lock(dep->mutex);
+    if (!dep->done) {
+      ++node->pending;
+      dep->dependents.push_back(node);
+    }
+  }
+  if (--node->pending == 0)
+    enqueue(node);
+}
+
+void AssetPipeline::enqueue(std::shared_ptr<Node> node) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(node));
+  }
+  ready.notify_one();
+}
+
+void AssetPipeline::execute(const std::shared_ptr<Node> &node) {
+#ifdef _OPENMP
+  // 解析、去重和 finalize() 都在任务里开并行区域。单独执行的任务用满
+  // 全部线程，多个任务同时执行时平分，总线程数不超过 omp_threads。
+  // 主线程在 wait() 中也会执行任务，结束后恢复它原来的设置
+  const int previous = omp_get_max_threads();
+  omp_set_num_threads(std::max(1, omp_threads / ++running));
+  node->run();
+  --running;
+  omp_set_num_threads(previous);
+#else
+  node->run();
+#endif
+  node->run = nullptr;
+
+  std::vector<std::shared_ptr<Node>> dependents;
+  {
+    std::lock_guard<std::mutex> lock(node->mutex);
+    node->done = true;
+    dependents.swap(node->dependents);
+  }
+  for (auto &dependent : dependents) {
+    if (--dependent->pending == 0)
+      enqueue(std::move(dependent));
+  }
+}
+
+bool AssetPipeline::run_one() {
+  std::shared_ptr<Node> node;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queue.empty())
+      return false;
+    node = std::move(queue.front());
+    queue.pop_front();
+  }
+  execute(node);
+  return true;
+}
+
+void AssetPipeline::worker() {
+  for (;;) {
+    std::shared_ptr<Node> node;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+      if (queue.empty())
+        return;
+      node = std::move(queue.front());
+      queue.pop_front();
+    }
+    execute(node);
+  }
+}
+
+} // namespace utils
+} // namespace tracer
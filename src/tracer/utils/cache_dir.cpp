@@ -0,0 +1,54 @@
+#include "tracer/utils/cache_dir.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tracer {
+namespace utils {
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+std::string user_cache_dir(const std::string &name) {
+  std::error_code ec;
+  fs::path temp = fs::temp_directory_path(ec);
+  if (ec)
+    return "";
+  fs::path dir = temp / ("rayt_" + name);
+  fs::create_directories(dir, ec);
+  return fs::is_directory(dir, ec) ? dir.string() : "";
+}
+#else
+std::string user_cache_dir(const std::string &name) {
+  std::error_code ec;
+  fs::path dir;
+  const char *xdg = std::getenv("XDG_CACHE_HOME");
+  if (xdg && fs::path(xdg).is_absolute()) {
+    fs::create_directories(fs::path(xdg) / "rayt", ec);
+    dir = fs::path(xdg) / "rayt" / name;
+  } else {
+    fs::path temp = fs::temp_directory_path(ec);
+    if (ec)
+      return "";
+    dir = temp / ("rayt_" + name + "_" + std::to_string(::geteuid()));
+  }
+
+  ::mkdir(dir.c_str(), 0700);
+  struct stat st;
+  if (::lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) ||
+      st.st_uid != ::geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+    std::cerr << "缓存目录不可用（不存在、不属于当前用户或其他用户可写），"
+                 "已关闭缓存: "
+              << dir.string() << std::endl;
+    return "";
+  }
+  return dir.string();
+}
+#endif
+
+} // namespace utils
+} // namespace tracer
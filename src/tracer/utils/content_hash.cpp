@@ -0,0 +1,57 @@
+#include "tracer/utils/content_hash.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace tracer {
+namespace utils {
+
+static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static uint64_t mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  return h ^ (h >> 33);
+}
+
+// 四路独立累加，每次读 32 字节
+static uint64_t hash_block(const char *p, size_t n, uint64_t seed) {
+  static constexpr uint64_t P1 = 0x9e3779b185ebca87ull;
+  static constexpr uint64_t P2 = 0xc2b2ae3d27d4eb4full;
+  uint64_t lane[4] = {seed + P1 + P2, seed + P2, seed, seed - P1};
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    for (int k = 0; k < 4; ++k) {
+      uint64_t w;
+      std::memcpy(&w, p + i + 8 * k, 8);
+      lane[k] = rotl(lane[k] + w * P2, 31) * P1;
+    }
+  }
+  uint64_t h = rotl(lane[0], 1) + rotl(lane[1], 7) + rotl(lane[2], 12) +
+               rotl(lane[3], 18) + n;
+  for (; i < n; ++i)
+    h = rotl(h ^ (static_cast<uint8_t>(p[i]) * P1), 11) * P2;
+  return mix(h);
+}
+
+uint64_t content_hash(const void *data, size_t size, uint64_t seed) {
+  const char *bytes = static_cast<const char *>(data);
+  static constexpr size_t BLOCK = size_t(1) << 20;
+  const int64_t blocks = static_cast<int64_t>((size + BLOCK - 1) / BLOCK);
+  std::vector<uint64_t> partial(blocks);
+#pragma omp parallel for schedule(static)
+  for (int64_t b = 0; b < blocks; ++b) {
+    const size_t begin = static_cast<size_t>(b) * BLOCK;
+    partial[b] =
+        hash_block(bytes + begin, std::min(BLOCK, size - begin), seed + b);
+  }
+  uint64_t h = mix(seed ^ size);
+  for (uint64_t value : partial)
+    h = mix(h ^ value) + 0x9e3779b97f4a7c15ull;
+  return h;
+}
+
+} // namespace utils
+} // namespace tracer
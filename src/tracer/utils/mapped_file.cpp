@@ -0,0 +1,74 @@
+#include "tracer/utils/mapped_file.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tracer {
+namespace utils {
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) {
+  HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (f == INVALID_HANDLE_VALUE)
+    return;
+  file = f;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(f, &size) || size.QuadPart == 0)
+    return;
+  HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m)
+    return;
+  mapping = m;
+
+  void *view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+  if (!view)
+    return;
+  ptr = static_cast<const char *>(view);
+  length = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+  if (ptr)
+    UnmapViewOfFile(ptr);
+  if (mapping)
+    CloseHandle(mapping);
+  if (file)
+    CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                        MAP_PRIVATE, fd, 0);
+    if (view != MAP_FAILED) {
+      // 顺序读取为主，提示内核提前预读
+      ::madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+      ptr = static_cast<const char *>(view);
+      length = static_cast<size_t>(st.st_size);
+    }
+  }
+  // 映射建立后文件描述符就不再需要
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (ptr)
+    ::munmap(const_cast<char *>(ptr), length);
+}
+#endif
+
+} // namespace utils
+} // namespace tracer
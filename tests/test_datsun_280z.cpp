@@ -5,7 +5,10 @@
 
 using namespace tracer;
 
-int main() {
+// 默认开启背面剔除；传入 --no-cull 关闭，用于对比渲染时间
+int main(int argc, char **argv) {
+  bool cull = !(argc > 1 && std::string(argv[1]) == "--no-cull");
+
   const int image_width = 1200;
   const int image_height = 600;
   const int samples_per_pixel = 128;
@@ -21,7 +24,8 @@ int main() {
   hittable_list world;
   hittable_list lights;
 
-  obj_parser::Object obj("../models/free-datsun-280z/Datsun_280Z.obj");
+  obj_parser::Object obj("../models/free-datsun-280z/Datsun_280Z.obj",
+                        cull ? CullMode::Back : CullMode::None);
 
   std::shared_ptr<geometry::Mesh> mesh = obj.take();
   size_t vn = mesh->indices.size();
@@ -29,7 +33,10 @@ int main() {
   std::cout << "[Build] 开始构建 BVH ..." << std::endl;
   auto start_time = std::chrono::high_resolution_clock::now();
 
+  mesh->vertex_format = geometry::VertexFormat::Compact;
+  mesh->compact_indices = true;
   mesh->finalize();
+  mesh->print_memory_stats();
   world.add(mesh);
 
   auto end_time = std::chrono::high_resolution_clock::now();
@@ -51,6 +58,9 @@ int main() {
   Camera camera(image_width, image_height, samples_per_pixel, max_depth,
                 "test_datsun_280z.png", background, lookfrom, lookat, vup,
                 90.0f);
-  camera.render(bvh, lights, false);
+  {
+    utils::RenderTimer timer(cull ? "渲染（背面剔除）" : "渲染（无剔除）");
+    camera.render(bvh, lights, false);
+  }
   return 0;
 }
\ No newline at end of file
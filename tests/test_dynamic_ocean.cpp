@@ -13,7 +13,7 @@ int main() {
   Vec3 vup(0.0f, 0.0f, 1.0f);
   Vec3 forward = unit_vector(lookat - lookfrom);
 
-  std::shared_ptr<Background> background = std::make_shared<ImageBackground>(
+  auto background = std::make_shared<ImageBackground>(
       "../textures/autumn_field_puresky_4k.hdr", forward, vup);
 
   int nx = 4096;
@@ -30,10 +30,10 @@ int main() {
   //   auto water_mat =
   //       std::make_shared<material::Metal>(Vec3(0.5294f, 0.8078f, 0.9216f),
   //       0.8f);
-  auto sun_mat =
-      std::make_shared<material::DiffuseLight>(Vec3(15.0f, 15.0f, 15.0f));
-  auto light = std::make_shared<geometry::Sphere>(Vec3(0.0f, 0.0f, 1000.0f),
-                                                  30.0f, sun_mat);
+  // 正上方的太阳，角半径与原先 1000 米外半径 30 米的球形光源相当
+  auto sun = std::make_shared<geometry::DistantLight>(
+      Vec3(0.0f, 0.0f, 1.0f), 1.7f, Vec3(15.0f, 15.0f, 15.0f));
+  background->add_sun(sun);
   auto ocean =
       std::make_shared<geometry::Ocean>(&*fft_solver, water_mat, 1.2f, 1.0f);
   ocean->update_at_time(0.0f);
@@ -47,7 +47,8 @@ int main() {
   world.add(std::make_shared<geometry::XYRect>(
       -15000.0f, 15000.0f, -15000.0f, 15000.0f, -5000.0f, sea_floor_mat));
   world.add(ocean);
-  lights.add(light);
+  lights.add(sun);
+  lights.add(std::make_shared<geometry::EnvironmentLight>(background));
 
   Camera camera(image_width, image_height, samples_per_pixel, max_depth,
                 "image.png", background, lookfrom, lookat, vup, 60.0f);
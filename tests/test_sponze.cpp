@@ -16,12 +16,14 @@ int main() {
   Vec3 vup(0.0f, 1.0f, 0.0f);
   Vec3 forward = unit_vector(lookat - lookfrom);
 
-  std::shared_ptr<Background> background = std::make_shared<ImageBackground>(
+  auto background = std::make_shared<ImageBackground>(
       "../textures/autumn_field_puresky_4k.hdr", forward, vup);
 
   hittable_list world;
   hittable_list lights;
 
+  // 贴图按需分页加载，所有纹理页共用 256 MB 内存
+  texture::TextureCache::instance().enable_streaming(size_t(256) << 20);
   obj_parser::Object obj("../models/sponza/sponza.obj");
 
   std::shared_ptr<geometry::Mesh> mesh = obj.take();
@@ -36,9 +38,13 @@ int main() {
     std::cout << "Sponza Min: " << box.min << std::endl;
     std::cout << "Sponza Max: " << box.max << std::endl;
   }
-  world.add(std::make_shared<transform::Translate>(
+  auto sponza = std::make_shared<transform::Translate>(
       std::make_shared<transform::RotateY>(mesh, 90.0f),
-      Vec3(0.0f, 0.0f, 0.0f)));
+      Vec3(0.0f, 0.0f, 0.0f));
+  world.add(sponza);
+  // mtl 中带 Ke / map_Ke 的三角形作为面光源参与直接光照采样
+  if (auto emitters = sponza->light_source())
+    lights.add(emitters);
   //   world.add(mesh);
 
   auto end_time = std::chrono::high_resolution_clock::now();
@@ -54,11 +60,13 @@ int main() {
                                                   300.0f, sun_mat);
 
   lights.add(light);
+  lights.add(std::make_shared<geometry::EnvironmentLight>(background));
   world.add(light);
   BVH bvh(world);
 
   Camera camera(image_width, image_height, samples_per_pixel, max_depth,
                 "test_sponze.png", background, lookfrom, lookat, vup, 60.0f);
   camera.render(bvh, lights, false);
+  texture::TileCache::instance().report();
   return 0;
 }
\ No newline at end of file